@@ -0,0 +1,113 @@
+//
+//  actors.hpp
+//  playground
+//
+//  Created by Emil Ahlbäck on 16.07.20.
+//  Copyright © 2020 Emil Ahlbäck. All rights reserved.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <string_view>
+
+#include "typedefs.hpp"
+#include "raster.hpp"
+
+constexpr size_t round_downwards(size_t number, size_t pow2 = 2) {
+    return number - (pow2 - 1) & ~(pow2 - 1);
+}
+
+constexpr std::pair<size_t, size_t> split_value(size_t number)
+{
+    if (number % 2 == 0) return {number / 2, number / 2};
+    else return {number / 2, number / 2 + number % 2};
+}
+
+
+namespace button
+{
+// Simulating vertical space needed to render a button
+constexpr auto y_needed_by_text = 1.0f;
+constexpr auto border_size = 1.0f; // per side
+} // namespace button
+
+// The space a button takes on stage, without painting it. Usable in constant expressions.
+constexpr auto measure_button = []<class T>(const val::BasicInstruction<T>& instr, std::string_view script) -> val::BasicStage<T>
+{
+    constexpr auto y_needed_by_text = static_cast<T>(button::y_needed_by_text);
+    constexpr auto border_size = static_cast<T>(button::border_size);
+    
+    // Note: The second values (instr.first.second, instr.first.second) are not
+    //       relative to their preceding values, i.e. it the first value is 20
+    //       and the director desires a width of 20, the value will be 40. The
+    //       same goes for any offsets. Director gives absolute positions!
+    const auto x_start = val::extract(instr.horizontal.low);
+    const auto x_absolute_end = val::extract(instr.horizontal.high);
+    const auto y_start = val::extract(instr.vertical.low);
+    const auto x_relative_end = std::max<T>(x_absolute_end - x_start, 0); // nothing fits past the end
+    const auto x_end = val::resolve_direction(instr.horizontal.high, x_start + static_cast<T>(std::min(script.size(), static_cast<size_t>(x_relative_end))) + border_size * 2);
+    
+    const T y_end = y_start + val::resolve_direction(instr.vertical.high, y_needed_by_text + (border_size * 2));
+    return val::BasicStage<T>{x_start, x_end, y_start, static_cast<T>(y_end-1)}; // -1 because array indices? [15] = row 16
+};
+
+// Paints a button into the stage it was given by the producer. The raster
+// kernels clip, so the stage may lie partly (or entirely) off screen; stages
+// that are empty or inverted paint nothing, and one too narrow for the text
+// paints its border alone.
+const auto paint_button = []<class T>(val::Screen& screen, const val::BasicStage<T>& stage, std::string_view script)
+{
+    using coordinate = val::raster::coordinate;
+    constexpr auto border_dim = static_cast<coordinate>(button::border_size);
+    constexpr val::raster::BoxStyle frame { '|', '-', '|', ' ' };
+    
+    const val::Stage bounds { static_cast<float>(stage.left), static_cast<float>(stage.right),
+                              static_cast<float>(stage.top), static_cast<float>(stage.bottom) };
+    if (!val::raster::visible(bounds, screen.buffer)) return;
+    
+    // const size_t text_height = static_cast<size_t>(y_needed_by_text);
+    const auto col_start     = val::raster::cell_of(stage.left);
+    const auto col_end       = val::raster::cell_of(stage.right);
+    if (col_start >= col_end) return;
+    
+    // Signed and clamped at 0, so a frame narrower than its borders has no room for text
+    const auto final_width   = col_end - col_start;
+    const auto text_room     = std::max<coordinate>(final_width - border_dim * 2, 0);
+    const auto final_script  = script.substr(0, static_cast<size_t>(std::min<coordinate>(text_room, static_cast<coordinate>(script.size()))));
+    const auto script_width  = static_cast<coordinate>(final_script.length());
+    const auto left_padding  = std::max<coordinate>(final_width - script_width, 0) / 2;
+    
+    const auto frame_y_start = val::raster::cell_of(stage.top);
+    const auto frame_y_end   = val::raster::cell_of(stage.bottom);
+    const auto text_x_start  = col_start + left_padding;
+    const auto text_y_start  = frame_y_start + ((frame_y_end - frame_y_start) / 2);
+    
+    auto& buffer = screen.buffer;
+    
+    // The frame, then the text row (which sits on the top border for two-row
+    // buttons, while a single-row button is all border)
+    val::raster::frame_box(buffer, col_start, col_end, frame_y_start, frame_y_end + 1, frame);
+    if (text_y_start == frame_y_end) return;
+    val::raster::framed_run(buffer, text_y_start, col_start, col_end, frame.vertical, frame.fill);
+    val::raster::blit_text(buffer, text_y_start, text_x_start, final_script);
+};
+
+// The paint closure views `script`; see the lifetime note on val::BasicActor
+const auto renderer = [](const val::Instruction& instr, std::string_view script) -> const val::preproduction
+{
+    const auto stage = measure_button(instr, script);
+    
+    // TODO: Would be nice if this was {{instr, x}, {instr, y}}
+    // i.e. that the constructors could handle it for us
+    
+    return {
+        stage,
+        [script, stage](val::Screen& screen) { paint_button(screen, stage, script); }
+    };
+
+};
+
+// The button as a split actor: measure_button and paint_button as separate phases.
+// Its lambdas have internal linkage, and so does it: unused in most TUs.
+[[maybe_unused]] const val::BasicSplitActor button_actor { measure_button, paint_button };
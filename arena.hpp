@@ -0,0 +1,122 @@
+//
+//  arena.hpp
+//  playground
+//
+//  Per-frame monotonic allocation for layout and paint.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+
+namespace val
+{
+
+// Forwards to `upstream` and counts what reaches it
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    explicit CountingResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+    : upstream_ { upstream }
+    {}
+
+    size_t allocations() const { return allocations_; }
+    size_t bytes() const { return bytes_; }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override
+    {
+        ++allocations_;
+        bytes_ += bytes;
+        return upstream_->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override
+    {
+        upstream_->deallocate(pointer, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource*  upstream_;
+    size_t                      allocations_ {0};
+    size_t                      bytes_ {0};
+};
+
+/*
+ * A monotonic arena for everything a frame allocates (display lists, batches,
+ * paint scratch), released in one go by reset().
+ *
+ * The arena serves from one owned block. When a frame outgrows it, the spill
+ * goes to the heap and the block is grown on the next reset(), so after a few
+ * warm-up frames of similar size a frame performs no heap allocations at all.
+ * Every allocation that reaches the heap is counted, see heap_allocations().
+ *
+ * Objects allocated from the arena must be destroyed before reset().
+ */
+class FrameArena
+{
+public:
+    explicit FrameArena(size_t initial_bytes = 64 * 1024)
+    {
+        grow(initial_bytes);
+    }
+
+    ~FrameArena()
+    {
+        resource_.reset();
+        heap_.deallocate(block_, capacity_, alignof(std::max_align_t));
+    }
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    std::pmr::memory_resource* resource() { return &*resource_; }
+
+    // Ends the frame, growing the block if this frame did not fit into it
+    void reset()
+    {
+        const size_t spilled = heap_.bytes() - frame_start_bytes_;
+        resource_.reset();
+        if (spilled > 0)
+        {
+            heap_.deallocate(block_, capacity_, alignof(std::max_align_t));
+            grow((capacity_ + spilled) * 2);
+        }
+        else resource_.emplace(block_, capacity_, &heap_);
+        frame_start_allocations_ = heap_.allocations();
+        frame_start_bytes_ = heap_.bytes();
+    }
+
+    // Heap allocations since construction, including growth of the block
+    size_t heap_allocations() const { return heap_.allocations(); }
+
+    // Heap allocations since the last reset()
+    size_t frame_heap_allocations() const { return heap_.allocations() - frame_start_allocations_; }
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    void grow(size_t capacity)
+    {
+        capacity_ = capacity;
+        block_ = heap_.allocate(capacity_, alignof(std::max_align_t));
+        resource_.emplace(block_, capacity_, &heap_);
+        frame_start_allocations_ = heap_.allocations();
+        frame_start_bytes_ = heap_.bytes();
+    }
+
+    CountingResource                                    heap_ {};
+    void*                                               block_ {nullptr};
+    size_t                                              capacity_ {0};
+    std::optional<std::pmr::monotonic_buffer_resource>  resource_ {};
+    size_t                                              frame_start_allocations_ {0};
+    size_t                                              frame_start_bytes_ {0};
+};
+
+} // namespace val
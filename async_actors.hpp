@@ -0,0 +1,335 @@
+//
+//  async_actors.hpp
+//  playground
+//
+//  Actors that measure asynchronously, laid out around placeholders meanwhile.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "typedefs.hpp"
+#include "batch.hpp"
+#include "raster.hpp"
+#include "instrument.hpp"
+
+namespace val
+{
+
+/*
+ * A value that arrives later (font metrics, a remote label), for measuring
+ * coroutines to co_await. set() resumes every coroutine waiting for it, on the
+ * calling thread: deliver values on the thread that lays out. Awaiting a value
+ * that is already set does not suspend. A Pending stays where it is (it cannot
+ * be moved); a coroutine destroyed while waiting stops waiting.
+ */
+template<class T>
+class Pending
+{
+public:
+    class Awaiter
+    {
+    public:
+        explicit Awaiter(const Pending& source) : source_ { &source } {}
+        ~Awaiter() { if (linked_) source_->unlink(this); }
+
+        Awaiter(const Awaiter&) = delete;
+        Awaiter& operator=(const Awaiter&) = delete;
+
+        bool await_ready() const noexcept { return source_->value_.has_value(); }
+        void await_suspend(std::coroutine_handle<> handle) { handle_ = handle; source_->link(this); }
+        const T& await_resume() const { return *source_->value_; }
+
+    private:
+        friend class Pending;
+
+        const Pending*          source_;
+        std::coroutine_handle<> handle_ {};
+        Awaiter*                previous_ {nullptr};
+        Awaiter*                next_ {nullptr};
+        bool                    linked_ {false};
+    };
+
+    Pending() = default;
+    ~Pending() { while (first_) unlink(first_); }
+
+    Pending(const Pending&) = delete;
+    Pending& operator=(const Pending&) = delete;
+
+    bool ready() const { return value_.has_value(); }
+    const T& value() const { return *value_; }
+
+    void set(T value)
+    {
+        if (value_) throw std::logic_error("Pending value set twice");
+        value_.emplace(std::move(value));
+        while (first_)
+        {
+            const auto handle = first_->handle_;
+            unlink(first_);
+            handle.resume();
+        }
+    }
+
+    Awaiter operator co_await() const { return Awaiter { *this }; }
+
+private:
+    void link(Awaiter* awaiter) const
+    {
+        awaiter->previous_ = last_;
+        (last_ ? last_->next_ : first_) = awaiter;
+        last_ = awaiter;
+        awaiter->linked_ = true;
+    }
+
+    void unlink(Awaiter* awaiter) const
+    {
+        (awaiter->previous_ ? awaiter->previous_->next_ : first_) = awaiter->next_;
+        (awaiter->next_ ? awaiter->next_->previous_ : last_) = awaiter->previous_;
+        awaiter->previous_ = awaiter->next_ = nullptr;
+        awaiter->linked_ = false;
+    }
+
+    std::optional<T>    value_ {};
+    mutable Awaiter*    first_ {nullptr};   // waiting coroutines, resumed in order
+    mutable Awaiter*    last_ {nullptr};
+};
+
+/*
+ * The stage an asynchronous measure answers with, now or later. A measure
+ * that knows the size at once just returns a Stage, and no coroutine is
+ * involved; one that has to wait is a coroutine that co_awaits what it needs
+ * and co_returns the stage. Coroutines run eagerly up to their first
+ * suspension, and should take the instruction by value: the caller's
+ * arguments are gone by the time they resume.
+ *
+ * Every coroutine call allocates its frame, so keep the common case out of
+ * it: a measure that returns a Stage when it can, and calls a coroutine only
+ * when it has to wait, allocates for the scenes that wait alone.
+ */
+class Measurement
+{
+public:
+    struct promise_type
+    {
+        std::optional<Stage>    stage {};
+        std::exception_ptr      error {};
+
+        Measurement get_return_object() { return Measurement { std::coroutine_handle<promise_type>::from_promise(*this) }; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_always final_suspend() const noexcept { return {}; }
+        void return_value(const Stage& result) { stage.emplace(result); }
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    Measurement(const Stage& stage) : stage_ { stage } {}
+
+    Measurement(Measurement&& other) noexcept
+    : handle_ { std::exchange(other.handle_, {}) }, stage_ { other.stage_ }
+    {}
+
+    Measurement& operator=(Measurement&& other) noexcept
+    {
+        if (this == &other) return *this;
+        if (handle_) handle_.destroy();
+        handle_ = std::exchange(other.handle_, {});
+        stage_.reset();
+        if (other.stage_) stage_.emplace(*other.stage_);
+        return *this;
+    }
+
+    ~Measurement() { if (handle_) handle_.destroy(); }
+
+    bool ready() const { return !handle_ || handle_.done(); }
+
+    // The measured stage, once ready(); rethrows what the measure threw
+    Stage stage() const
+    {
+        if (!handle_) return *stage_;
+        const auto& promise = handle_.promise();
+        if (promise.error) std::rethrow_exception(promise.error);
+        return *promise.stage;
+    }
+
+private:
+    explicit Measurement(std::coroutine_handle<promise_type> handle) : handle_ { handle } {}
+
+    std::coroutine_handle<promise_type> handle_ {};
+    std::optional<Stage>                stage_ {};
+};
+
+// Any Measures qualifies as well: its Stage converts to a ready Measurement
+template<class F>
+concept MeasuresAsync = std::is_invocable_r_v<Measurement, const F&, const Instruction&, std::string_view>;
+
+/*
+ * An actor whose measure may have to wait. Until it answers, its scene is laid
+ * out with the stage the placeholder gives (any Measures: a fixed box, or a
+ * cheap estimate such as measure_button) and left blank when painting, so the
+ * rest of the frame does not wait for it.
+ */
+template<MeasuresAsync TMeasure, Paints TPaint, Measures TPlaceholder>
+struct BasicAsyncActor
+{
+    const TMeasure      measure;
+    const TPaint        paint;
+    const TPlaceholder  placeholder;
+};
+
+// Reserves a width x height box where the instruction starts, as far as it allows
+struct FixedPlaceholder
+{
+    float width {1};
+    float height {1};
+
+    constexpr Stage operator()(const Instruction& instruction, std::string_view) const
+    {
+        const auto left = extract(instruction.horizontal.low);
+        const auto top  = extract(instruction.vertical.low);
+        return { left, resolve_direction(instruction.horizontal.high, left + width),
+                 top, resolve_direction(instruction.vertical.high, top + height) - 1 };
+    }
+};
+
+/*
+ * produce_scenes for asynchronous actors. layout() places every scene at once:
+ * measurements that are ready are used, the others are suspended and their
+ * scenes get the placeholder's stage. Once values have been delivered,
+ * settle() relays out from each scene whose measurement completed, keeping the
+ * StageLayout checkpoints of the previous pass like val::IncrementalLayout: a
+ * scene measuring exactly its placeholder moves nothing after it, otherwise
+ * the scenes after it are laid out (and measured) again until the layouts
+ * converge.
+ *
+ * Scripts are kept as views; see the lifetime note on val::BasicActor.
+ */
+template<class TDirector, class TActor>
+class AsyncLayout
+{
+public:
+    AsyncLayout(const Stage& stage, const StageLayout& initial, TDirector director, TActor actor)
+    : stage_ { stage }, director_ { std::move(director) }, actor_ { std::move(actor) }, checkpoints_ { initial }
+    {}
+
+    // Lays out every script from scratch; returns the number of scenes left pending
+    template<class TScripts>
+    size_t layout(const TScripts& scripts)
+    {
+        scripts_.assign(std::begin(scripts), std::end(scripts));
+        measurements_.clear();
+        waiting_.assign(scripts_.size(), false);
+        scenes_.clear();
+        scenes_.resize(scripts_.size());
+        checkpoints_.resize(1);
+        checkpoints_.resize(scripts_.size() + 1);
+        measurements_.reserve(scripts_.size());
+        for (size_t idx { 0 }; idx < scripts_.size(); ++idx) measurements_.emplace_back(Stage { 0, 0, 0, 0 });
+
+        const size_t start[] { 0 };
+        if (!scripts_.empty()) relayout(start, 0);
+        return pending();
+    }
+
+    // Takes in the measurements completed since the last call; returns the number of scenes laid out again
+    size_t settle()
+    {
+        std::vector<size_t> completed {};
+        for (size_t idx { 0 }; idx < scripts_.size(); ++idx) if (waiting_[idx] && measurements_[idx].ready()) completed.push_back(idx);
+        return relayout(completed, scripts_.size());
+    }
+
+    // Paints every measured scene; pending ones stay blank
+    void paint(Screen& screen) const
+    {
+        THEATER_SCOPE(paint, "async_layout");
+        for (size_t idx { 0 }; idx < scenes_.size(); ++idx)
+        {
+            if (waiting_[idx]) continue;
+            const auto stage = scenes_.stage(idx);
+            if (raster::visible(stage, screen.buffer)) actor_.paint(screen, stage, scripts_[idx]);
+        }
+    }
+
+    size_t pending() const { return static_cast<size_t>(std::count(waiting_.begin(), waiting_.end(), true)); }
+    bool is_pending(size_t idx) const { return waiting_[idx]; }
+
+    const SceneBatch& scenes() const { return scenes_; }
+    const std::vector<StageLayout>& checkpoints() const { return checkpoints_; }
+    const StageLayout& final_layout() const { return checkpoints_.back(); }
+
+private:
+    /*
+     * Lays out from each of `dirty` (ascending) on. The first scene of a run
+     * keeps its completed measurement, since its checkpoint did not move; the
+     * scenes after it are measured again with their new instructions.
+     */
+    size_t relayout(std::span<const size_t> dirty, size_t retained)
+    {
+        THEATER_SCOPE(layout, director_.name);
+        const size_t count = scripts_.size();
+        size_t relaid { 0 };
+        bind_director(director_, stage_, [&](const auto& director) {
+            auto next_dirty = dirty.begin();
+            while (next_dirty != dirty.end())
+            {
+                size_t idx = *next_dirty;
+                for (bool remeasure = idx >= retained; idx < count; ++idx, remeasure = true)
+                {
+                    const auto& before = checkpoints_[idx];
+                    const auto placed  = place(director, idx, remeasure);
+                    const auto after   = director.adjust(stage_, placed, before);
+                    scenes_.assign(idx, placed, idx);
+                    ++relaid;
+
+                    const bool converged = idx + 1 < retained && after == checkpoints_[idx + 1];
+                    checkpoints_[idx + 1] = after;
+                    if (converged) break;
+                }
+                next_dirty = std::upper_bound(next_dirty, dirty.end(), idx);
+            }
+        });
+        return relaid;
+    }
+
+    template<class TBound>
+    Stage place(const TBound& director, size_t idx, bool remeasure)
+    {
+        if (remeasure)
+        {
+            const Instruction instruction = director.instruct(stage_, checkpoints_[idx]);
+            measurements_[idx] = actor_.measure(instruction, scripts_[idx]);
+            if (!measurements_[idx].ready())
+            {
+                THEATER_COUNT("scenes_suspended", 1);
+                waiting_[idx] = true;
+                return actor_.placeholder(instruction, scripts_[idx]);
+            }
+        }
+        // A measurement that threw leaves the scene waiting, and painting skips it
+        const Stage stage = measurements_[idx].stage();
+        waiting_[idx] = false;
+        return stage;
+    }
+
+    const Stage                     stage_;
+    const TDirector                 director_;
+    const TActor                    actor_;
+
+    std::vector<std::string_view>   scripts_ {};
+    std::vector<Measurement>        measurements_ {};
+    std::vector<bool>               waiting_ {};
+    SceneBatch                      scenes_ {};
+    std::vector<StageLayout>        checkpoints_ {};
+};
+
+} // namespace val
@@ -0,0 +1,457 @@
+//
+//  bench.cpp
+//  playground
+//
+//  Layout benchmarks. Build and run with ./bench [filter] [max items]
+//
+
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "typedefs.hpp"
+#include "directors.hpp"
+#include "actors.hpp"
+#include "producers.hpp"
+#include "packed.hpp"
+#include "batch.hpp"
+#include "display_list.hpp"
+#include "arena.hpp"
+#include "scan.hpp"
+#include "measure_cache.hpp"
+#include "layout_cache.hpp"
+#include "window.hpp"
+#include "present.hpp"
+#include "flow.hpp"
+#include "async_actors.hpp"
+#include "shard.hpp"
+#include "bench.hpp"
+
+namespace bench
+{
+// The per-character painter paint_button replaced, kept as the reference
+void legacy_paint_button(val::Screen& screen, const val::Stage& stage, const std::string& script)
+{
+    const size_t border_dim  = 1;
+    const size_t col_start   = static_cast<size_t>(stage.left);
+    const size_t col_end     = static_cast<size_t>(stage.right);
+    const size_t final_width = col_end - col_start;
+    const auto final_script  = script.substr(0, final_width - (border_dim * 2));
+    const auto [left_padding, right_padding] = split_value(final_width - final_script.length());
+    const auto frame_y_start = static_cast<size_t>(stage.top);
+    const auto frame_y_end   = static_cast<size_t>(stage.bottom);
+    const auto text_x_start  = col_start + left_padding;
+    const auto text_y_start  = frame_y_start + ((frame_y_end - frame_y_start) / 2);
+    const size_t filler_col_count { final_width - border_dim*2 };
+
+    auto& buffer = screen.buffer;
+    size_t col_idx {col_start};
+    for (const auto c : "|" + std::string(filler_col_count, '-') + "|") buffer[frame_y_start][col_idx++] = c;
+    for (auto row_idx { frame_y_start + 1 }; row_idx < text_y_start; ++row_idx) {
+        col_idx = col_start;
+        for (const auto c : "|" + std::string(filler_col_count, ' ') + "|") buffer[row_idx][col_idx++] = c;
+    }
+    buffer[text_y_start][col_start] = '|';
+    col_idx = text_x_start;
+    for (const auto c : final_script) buffer[text_y_start][col_idx++] = c;
+    for (const auto c : std::string(right_padding - border_dim, ' ') + '|') buffer[text_y_start][col_idx++] = c;
+    for (auto row_idx { text_y_start + 1 }; row_idx < frame_y_end; ++row_idx) {
+        col_idx = col_start;
+        for (const auto c : "|" + std::string(filler_col_count, ' ') + "|") buffer[row_idx][col_idx++] = c;
+    }
+    col_idx = col_start;
+    for (const auto c : "|" + std::string(filler_col_count, '-') + "|") buffer[frame_y_end][col_idx++] = c;
+}
+
+std::vector<std::string> make_scripts(size_t count)
+{
+    std::vector<std::string> scripts {};
+    scripts.reserve(count);
+    for (size_t idx { 0 }; idx < count; ++idx) scripts.push_back("Button " + std::to_string(idx));
+    return scripts;
+}
+
+// Stages large enough that no button of `count` is ever clamped
+val::Stage wide_stage(size_t count) { return { 0, 16.0f * static_cast<float>(count) + 16, 0, 3 }; }
+val::Stage tall_stage(size_t count) { return { 0, 80, 0, 4.0f * static_cast<float>(count) + 4 }; }
+
+// tall_stage in whole cells; int16_t stages fit 8190 buttons at most
+template<class T>
+val::BasicStage<T> tall_cells(size_t count) { return { 0, 80, 0, static_cast<T>(4 * count + 4) }; }
+
+constexpr size_t actor_counts[] { 10, 100, 1'000, 10'000, 100'000, 1'000'000 };
+
+std::string label(std::string_view what, size_t count)
+{
+    return std::string(what) + "/" + std::to_string(count);
+}
+
+void resolve_axis_benchmarks()
+{
+    for (const size_t count : actor_counts)
+    {
+        if (!enabled("resolve_axis", count)) continue;
+        std::vector<val::AxisDirection> axes {};
+        std::vector<float> lows, highs, incoming, resolved(count);
+        std::vector<std::uint8_t> strictness {};
+        for (size_t idx { 0 }; idx < count; ++idx)
+        {
+            const float low = static_cast<float>(idx % 17);
+            const float high = low + static_cast<float>(idx % 29);
+            const auto lower = idx % 2 ? dir::Strict(low) : dir::Lenient(low);
+            const auto upper = idx % 3 ? dir::Lenient(high) : dir::Strict(high);
+            axes.push_back({ lower, upper });
+            const auto packed = val::pack(axes.back());
+            lows.push_back(packed.low);
+            highs.push_back(packed.high);
+            strictness.push_back(packed.strictness);
+            incoming.push_back(static_cast<float>(idx % 41));
+        }
+
+        run(label("resolve_axis variant", count), count, repetitions_for(count), [&] {
+            for (size_t idx { 0 }; idx < count; ++idx) resolved[idx] = val::resolve_axis(axes[idx], incoming[idx]);
+        });
+        run(label("resolve_axis_batch packed", count), count, repetitions_for(count), [&] {
+            val::resolve_axis_batch({ lows, highs, strictness }, incoming, resolved);
+        });
+    }
+}
+
+void act_scene_benchmarks()
+{
+    const std::string script { "Button 42" };
+    for (const size_t count : { size_t { 1'000 }, size_t { 100'000 } })
+    {
+        const val::Set set { tall_stage(count), {}, val::Crew { dir::stack::vertically, val::Actor { renderer } } };
+        const val::BasicSet static_set { tall_stage(count), {}, val::BasicCrew { dir::stack::statically::vertically, val::BasicActor { renderer } } };
+        run(label("act_scene std::function", count), count, repetitions_for(count), [&] {
+            for (size_t idx { 0 }; idx < count; ++idx) act_scene(set, script);
+        });
+        run(label("act_scene static", count), count, repetitions_for(count), [&] {
+            for (size_t idx { 0 }; idx < count; ++idx) act_scene(static_set, script);
+        });
+        run(label("play_scene std::function", count), count, repetitions_for(count), [&] {
+            val::Rehearsal rehearsal { set };
+            for (size_t idx { 0 }; idx < count; ++idx) play_scene(rehearsal, script);
+        });
+        run(label("play_scene static", count), count, repetitions_for(count), [&] {
+            val::BasicRehearsal rehearsal { static_set };
+            for (size_t idx { 0 }; idx < count; ++idx) play_scene(rehearsal, script);
+        });
+    }
+}
+
+void produce_scenes_benchmarks()
+{
+    const auto produce = [](const char* name, size_t count, const auto& set, const auto& scripts) {
+        run(label(name, count), count, repetitions_for(count), [&] {
+            TPerformanceBuffer into {};
+            into.reserve(count);
+            produce_scenes(set, into, scripts);
+        });
+    };
+
+    for (const size_t count : actor_counts)
+    {
+        if (!enabled("produce_scenes", count) && !enabled("layout_batch", count)) continue;
+        const auto scripts = make_scripts(count);
+        const auto wide = wide_stage(count), tall = tall_stage(count);
+        const val::Actor actor { renderer };
+        const val::BasicActor static_actor { renderer };
+
+        produce("produce_scenes horizontally", count, val::Set { wide, {}, val::Crew { dir::stack::horizontally, actor } }, scripts);
+        produce("produce_scenes vertically", count, val::Set { tall, {}, val::Crew { dir::stack::vertically, actor } }, scripts);
+        produce("produce_scenes magically", count, val::Set { tall, {}, val::Crew { dir::stack::magically, actor } }, scripts);
+        produce("produce_scenes static horizontally", count,
+                val::BasicSet { wide, {}, val::BasicCrew { dir::stack::statically::horizontally, static_actor } }, scripts);
+        produce("produce_scenes static vertically", count,
+                val::BasicSet { tall, {}, val::BasicCrew { dir::stack::statically::vertically, static_actor } }, scripts);
+        produce("produce_scenes static magically", count,
+                val::BasicSet { tall, {}, val::BasicCrew { dir::stack::statically::magically, static_actor } }, scripts);
+
+        run(label("layout_batch static horizontally", count), count, repetitions_for(count), [&] {
+            val::SceneBatch batch {};
+            layout_batch(wide, {}, dir::stack::statically::horizontally, measure_button, scripts, batch);
+        });
+        run(label("layout_batch static vertically", count), count, repetitions_for(count), [&] {
+            val::SceneBatch batch {};
+            layout_batch(tall, {}, dir::stack::statically::vertically, measure_button, scripts, batch);
+        });
+        // Right after vertically, which magically binds to on this stage
+        run(label("layout_batch static magically", count), count, repetitions_for(count), [&] {
+            val::SceneBatch batch {};
+            layout_batch(tall, {}, dir::stack::statically::magically, measure_button, scripts, batch);
+        });
+        run(label("layout_batch magically", count), count, repetitions_for(count), [&] {
+            val::SceneBatch batch {};
+            layout_batch(tall, {}, dir::stack::magically, measure_button, scripts, batch);
+        });
+        run(label("layout_batch static vertically int32", count), count, repetitions_for(count), [&] {
+            val::BasicSceneBatch<std::int32_t> batch {};
+            layout_batch(tall_cells<std::int32_t>(count), {}, dir::stack::statically::vertically, measure_button, scripts, batch);
+        });
+        if (count <= 8190)
+        {
+            run(label("layout_batch static vertically int16", count), count, repetitions_for(count), [&] {
+                val::BasicSceneBatch<std::int16_t> batch {};
+                layout_batch(tall_cells<std::int16_t>(count), {}, dir::stack::statically::vertically, measure_button, scripts, batch);
+            });
+        }
+        run(label("layout_flex_wrap", count), count, repetitions_for(count), [&] {
+            val::SceneBatch batch {};
+            val::layout_flex_wrap(tall, {}, measure_button, scripts, batch);
+        });
+        run(label("layout_grid 4 columns", count), count, repetitions_for(count), [&] {
+            val::SceneBatch batch {};
+            val::layout_grid(tall, {}, measure_button, scripts, 4, batch);
+        });
+    }
+}
+
+void parallel_benchmarks()
+{
+    val::ThreadPool pool {};
+    for (const size_t count : { size_t { 100'000 }, size_t { 1'000'000 } })
+    {
+        if (!enabled("scan_layout", count)) continue;
+        const auto scripts = make_scripts(count);
+        run(label("scan_layout horizontally", count), count, repetitions_for(count), [&] {
+            val::SceneBatch batch {};
+            val::scan_layout(val::StackAxis::horizontal, wide_stage(count), {}, measure_button, scripts, pool, batch);
+        });
+        run(label("scan_layout vertically", count), count, repetitions_for(count), [&] {
+            val::SceneBatch batch {};
+            val::scan_layout(val::StackAxis::vertical, tall_stage(count), {}, measure_button, scripts, pool, batch);
+        });
+    }
+}
+
+void window_benchmarks()
+{
+    // One 80x24 screen worth of rows out of lists of growing length
+    for (const size_t count : actor_counts)
+    {
+        if (!enabled("layout_window", count)) continue;
+        const auto scripts = make_scripts(count);
+        const auto stage = tall_stage(count);
+        const auto index = val::RowIndex::fixed(count, 2, {});
+        const val::Viewport viewport { stage.bottom / 2, stage.bottom / 2 + 24 };
+        run(label("layout_window fixed rows", count), count, repetitions_for(count), [&] {
+            val::SceneBatch batch {};
+            val::layout_window(stage, index, measure_button, scripts, viewport, 4, batch);
+        });
+    }
+}
+
+void shard_benchmarks()
+{
+    // One instance of a 4x4 wall: measure its shard for the summary, then lay
+    // out the rows crossing its tile, vs. laying out everything
+    constexpr size_t count = 100'000, shards = 16;
+    if (!enabled("shard", count)) return;
+    const auto scripts = make_scripts(count);
+    const auto stage = tall_stage(count);
+    const val::TileGrid wall { stage, 4, 4 };
+    const auto tile = wall.tile(5);
+
+    run(label("shard summary 1 of 16", count), count, repetitions_for(count), [&] {
+        const auto [begin, end] = val::shard_range(count, 5, shards);
+        val::StackSummary::measured(stage, {}, measure_button, std::span { scripts }.subspan(begin, end - begin));
+    });
+    val::StackSummary summary { val::StageLayout {} };
+    for (size_t shard { 0 }; shard < shards; ++shard)
+    {
+        const auto [begin, end] = val::shard_range(count, shard, shards);
+        summary.append(val::StackSummary::measured(stage, {}, measure_button, std::span { scripts }.subspan(begin, end - begin)));
+    }
+    run(label("shard layout_tile 1 of 16", count), count, repetitions_for(count), [&] {
+        val::SceneBatch batch {};
+        val::layout_tile(stage, summary.index(), measure_button, scripts, tile, batch);
+    });
+    run(label("shard full layout", count), count, repetitions_for(count), [&] {
+        val::SceneBatch batch {};
+        layout_batch(stage, {}, dir::stack::statically::vertically, measure_button, scripts, batch);
+    });
+}
+
+void measure_cache_benchmarks()
+{
+    constexpr size_t count = 100'000;
+    if (!enabled("measure_cache", count)) return;
+    const auto scripts = make_scripts(count);
+
+    // Repeated frames: the first run fills the cache, the best run is all hits.
+    // measure_button is only a few arithmetic ops, so this measures the cache's
+    // own lookup cost; it pays off for measures that shape or fetch text.
+    const val::MeasureCache cached_measure { measure_button, count };
+    run(label("measure_cache layout_batch vertically", count), count, 5, [&] {
+        val::SceneBatch batch {};
+        layout_batch(tall_stage(count), {}, dir::stack::statically::vertically, std::cref(cached_measure), scripts, batch);
+    });
+}
+
+void layout_cache_benchmarks()
+{
+    // Layout-identical frames: after the first run every frame is a hit, which
+    // costs measuring the scripts once and recording them instead of directing them
+    for (const size_t count : { size_t { 1'000 }, size_t { 100'000 } })
+    {
+        if (!enabled("layout_cache", count)) continue;
+        const auto scripts = make_scripts(count);
+        const auto stage = tall_stage(count);
+        val::LayoutCache cache {};
+        run(label("layout_cache display list hit", count), count, repetitions_for(count), [&] {
+            val::DisplayList list {};
+            val::produce_display_list_cached(cache, stage, {}, dir::stack::statically::vertically, measure_button, scripts, list);
+        });
+        run(label("layout_cache uncached display list", count), count, repetitions_for(count), [&] {
+            val::DisplayList list {};
+            produce_display_list(stage, {}, dir::stack::statically::vertically, measure_button, scripts, list);
+        });
+    }
+}
+
+void async_layout_benchmarks()
+{
+    // One scene in a hundred waits for font metrics: lay out around its
+    // placeholder (measure_button as the estimate), deliver, then settle
+    for (const size_t count : { size_t { 10'000 }, size_t { 100'000 } })
+    {
+        if (!enabled("async_layout", count)) continue;
+        const auto scripts = make_scripts(count);
+        const auto stage = tall_stage(count);
+        const val::BasicAsyncActor ready_actor { measure_button, paint_button, measure_button };
+        run(label("async_layout all ready", count), count, repetitions_for(count), [&] {
+            val::AsyncLayout layout { stage, {}, dir::stack::statically::vertically, ready_actor };
+            layout.layout(scripts);
+        });
+
+        std::optional<val::Pending<float>> metrics {};
+        const auto with_icon = [&metrics](val::Stage measured) -> val::Measurement {
+            const float icon = co_await *metrics;
+            co_return val::Stage { measured.left, measured.right + icon, measured.top, measured.bottom };
+        };
+        const auto measure = [&with_icon](const val::Instruction& instruction, std::string_view script) -> val::Measurement {
+            const auto measured = measure_button(instruction, script);
+            if (!script.ends_with("00")) return measured;
+            return with_icon(measured);
+        };
+        const val::BasicAsyncActor waiting_actor { measure, paint_button, measure_button };
+        run(label("async_layout 1% pending, settled", count), count, repetitions_for(count), [&] {
+            metrics.emplace();
+            val::AsyncLayout layout { stage, {}, dir::stack::statically::vertically, waiting_actor };
+            layout.layout(scripts);
+            metrics->set(2);
+            layout.settle();
+        });
+    }
+}
+
+void frame_benchmarks()
+{
+    // Whole frames (layout, record, paint) served from a frame arena
+    constexpr size_t count = 1'000;
+    if (!enabled("arena frame", count)) return;
+    const auto scripts = make_scripts(count);
+    const auto stage = tall_stage(count);
+    auto screen = val::make_screen(80, static_cast<size_t>(stage.bottom));
+    val::FrameArena arena {};
+
+    const auto frame = [&] {
+        {
+            val::DisplayList list { arena.resource() };
+            produce_display_list(stage, {}, dir::stack::statically::vertically, measure_button, scripts, list);
+            val::rasterize(list, screen);
+        }
+        arena.reset();
+    };
+    for (size_t warm_up { 0 }; warm_up < 4; ++warm_up) frame();
+    run(label("arena frame vertically", count), count, 20, frame);
+}
+
+void paint_benchmarks()
+{
+    // Painting: per-character loops vs. the run-based raster kernels
+    constexpr size_t paint_count = 10'000;
+    auto screen = val::make_screen(200, 12);
+    const std::string text(120, 'x');
+    const val::Stage wide_button { 2, 190, 1, 10 };
+    run("paint legacy per-char loops 188x10", paint_count, 5, [&] {
+        for (size_t idx { 0 }; idx < paint_count; ++idx) legacy_paint_button(screen, wide_button, text);
+    });
+    run("paint_button raster kernels 188x10", paint_count, 5, [&] {
+        for (size_t idx { 0 }; idx < paint_count; ++idx) paint_button(screen, wide_button, text);
+    });
+}
+
+void screen_benchmarks()
+{
+    constexpr std::pair<size_t, size_t> sizes[] { { 80, 24 }, { 200, 60 }, { 1'000, 1'000 }, { 4'000, 4'000 } };
+    for (const auto& [width, height] : sizes)
+    {
+        const auto cells = width * height;
+        run(label("make_screen " + std::to_string(width) + "x" + std::to_string(height), cells), cells,
+            repetitions_for(cells), [&] { val::make_screen(width, height); });
+    }
+
+    // print_buffer to a null sink: one frame of a screen full of buttons
+    NullSink sink {};
+    {
+        const Redirect console { std::cout, &sink };
+        for (const auto& [width, height] : sizes)
+        {
+            const size_t rows = height / 3;
+            if (!enabled("print_buffer", rows)) continue;
+            const auto scripts = make_scripts(rows);
+            const val::Stage stage { 0, static_cast<float>(width), 0, static_cast<float>(height) };
+            TPerformanceBuffer buffer {};
+            produce_scenes(val::Set { stage, {}, val::Crew { dir::stack::vertically, val::Actor { renderer } } }, buffer, scripts);
+            const auto screen = val::make_screen(width, height);
+            run(label("print_buffer " + std::to_string(width) + "x" + std::to_string(height), rows), rows,
+                repetitions_for(width * height), [&] { print_buffer(buffer, screen); }, &sink);
+        }
+    }
+
+    // Damage-tracked presenting of a 200x60 screen where one row changes per
+    // frame, for each cell format: the diff compares one word per cell
+    const auto present = [&sink]<class TCell>(const char* name, TCell ink) {
+        constexpr size_t width = 200, height = 60;
+        std::ostream out { &sink };
+        val::BasicTerminalPresenter<TCell> presenter { out };
+        auto screen = val::make_screen<TCell>(width, height);
+        size_t frame { 0 };
+        run(label(name, width * height), width * height, repetitions_for(width * height), [&] {
+            const auto row = static_cast<val::raster::coordinate>(frame % height);
+            val::raster::blit_text(screen.buffer, row, 0, "changed row " + std::to_string(frame++), ink);
+            presenter.present(screen);
+        }, &sink);
+    };
+    present("present damage char", ' ');
+    present("present damage Cell16", val::Cell16 { ' ', { val::Color::red } });
+    present("present damage Cell32", val::Cell32 { U' ', { val::Color::red, val::Color::standard, true } });
+}
+} // namespace bench
+
+int main(int argc, char** argv)
+{
+    if (argc > 1) bench::options.filter = argv[1];
+    if (argc > 2) bench::options.max_items = std::strtoull(argv[2], nullptr, 10);
+
+    bench::print_header();
+    bench::resolve_axis_benchmarks();
+    bench::act_scene_benchmarks();
+    bench::produce_scenes_benchmarks();
+    bench::parallel_benchmarks();
+    bench::window_benchmarks();
+    bench::shard_benchmarks();
+    bench::measure_cache_benchmarks();
+    bench::layout_cache_benchmarks();
+    bench::async_layout_benchmarks();
+    bench::frame_benchmarks();
+    bench::paint_benchmarks();
+    bench::screen_benchmarks();
+    return 0;
+}
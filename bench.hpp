@@ -0,0 +1,126 @@
+//
+//  bench.hpp
+//  playground
+//
+//  A minimal benchmark harness: best-of-N timing, heap and output accounting.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+
+namespace bench
+{
+
+/*
+ * Heap traffic of the process. The benchmark executable replaces the global
+ * operator new to bump these, see bench_heap.cpp.
+ */
+inline std::atomic<size_t> heap_allocations {0};
+inline std::atomic<size_t> heap_bytes {0};
+
+// A stream buffer that discards everything written to it, but counts it
+class NullSink : public std::streambuf
+{
+public:
+    size_t bytes() const { return bytes_; }
+    void reset() { bytes_ = 0; }
+
+protected:
+    int_type overflow(int_type c) override
+    {
+        if (!traits_type::eq_int_type(c, traits_type::eof())) ++bytes_;
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char*, std::streamsize count) override
+    {
+        bytes_ += static_cast<size_t>(count);
+        return count;
+    }
+
+private:
+    size_t bytes_ {0};
+};
+
+// Points a stream at another buffer for as long as it lives, e.g. std::cout at a NullSink
+class Redirect
+{
+public:
+    Redirect(std::ostream& stream, std::streambuf* buffer) : stream_ { stream }, original_ { stream.rdbuf(buffer) } {}
+    ~Redirect() { stream_.rdbuf(original_); }
+
+    Redirect(const Redirect&) = delete;
+    Redirect& operator=(const Redirect&) = delete;
+
+private:
+    std::ostream&   stream_;
+    std::streambuf* original_;
+};
+
+struct Options
+{
+    std::string_view    filter {};          // only run benchmarks whose name contains this
+    size_t              max_items {1'000'000};
+};
+
+inline Options options {};
+
+inline bool enabled(std::string_view name, size_t items)
+{
+    return items <= options.max_items && name.find(options.filter) != std::string_view::npos;
+}
+
+inline void print_header()
+{
+    std::printf("%-52s %10s %12s %12s %14s\n", "benchmark", "items", "ns/item", "allocs/item", "bytes/frame");
+}
+
+/*
+ * Runs `fn` `repetitions` times (one run = one frame of `items` items) and
+ * reports the best time per item, heap allocations per item, and the bytes
+ * of the frame: heap bytes allocated, or the output produced when `output`
+ * is given.
+ */
+template<class F>
+void run(std::string_view name, size_t items, size_t repetitions, F&& fn, const NullSink* output = nullptr)
+{
+    if (!enabled(name, items)) return;
+
+    using clock = std::chrono::steady_clock;
+    double best = 1e300;
+    size_t allocations { 0 }, bytes { 0 };
+    for (size_t rep { 0 }; rep < std::max<size_t>(repetitions, 1); ++rep)
+    {
+        const size_t allocations_before = heap_allocations.load();
+        const size_t bytes_before = heap_bytes.load();
+        const size_t output_before = output ? output->bytes() : 0;
+
+        const auto start = clock::now();
+        fn();
+        const std::chrono::duration<double, std::nano> elapsed = clock::now() - start;
+
+        best = std::min(best, elapsed.count());
+        allocations = heap_allocations.load() - allocations_before;
+        bytes = output ? output->bytes() - output_before : heap_bytes.load() - bytes_before;
+    }
+
+    const double per_item = static_cast<double>(std::max<size_t>(items, 1));
+    std::printf("%-52.*s %10zu %12.2f %12.2f %14zu\n", static_cast<int>(name.size()), name.data(), items,
+                best / per_item, static_cast<double>(allocations) / per_item, bytes);
+}
+
+// Enough repetitions for stable numbers on small inputs, one run for huge ones
+constexpr size_t repetitions_for(size_t items)
+{
+    return std::clamp<size_t>(2'000'000 / std::max<size_t>(items, 1), 1, 50);
+}
+
+} // namespace bench
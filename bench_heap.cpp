@@ -0,0 +1,40 @@
+//
+//  bench_heap.cpp
+//  playground
+//
+//  Replaced global allocation functions feeding bench::heap_allocations.
+//
+
+/*
+ * These replace the global operator new/delete of the whole program: link this
+ * translation unit into the benchmark executables (see ./bench and ./replay).
+ * Defined out of line, so no caller sees a free() paired with a new.
+ */
+
+#include <cstdlib>
+#include <new>
+
+#include "bench.hpp"
+
+// Count every heap allocation of the process for the allocs/item column
+void* operator new(size_t size)
+{
+    bench::heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    bench::heap_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size ? size : 1)) return pointer;
+    throw std::bad_alloc {};
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    bench::heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    bench::heap_bytes.fetch_add(size, std::memory_order_relaxed);
+    const auto align = static_cast<size_t>(alignment);
+    if (void* pointer = std::aligned_alloc(align, (size + align - 1) / align * align)) return pointer;
+    throw std::bad_alloc {};
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { std::free(pointer); }
@@ -0,0 +1,162 @@
+//
+//  cell.hpp
+//  playground
+//
+//  Packed screen cells: a glyph plus colors and style in one word.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace val
+{
+
+/*
+ * The 16 color terminal palette, less bright black, plus the terminal's own
+ * default, so a color fits in 4 bits.
+ */
+enum class Color : std::uint8_t
+{
+    standard,
+    black, red, green, yellow, blue, magenta, cyan, white,
+    bright_red, bright_green, bright_yellow, bright_blue, bright_magenta, bright_cyan, bright_white
+};
+
+// Everything about a cell but its glyph
+struct Attributes
+{
+    Color   foreground  {Color::standard};
+    Color   background  {Color::standard};
+    bool    bold        {false};
+    bool    underline   {false};
+    bool    reverse     {false};
+
+    constexpr bool operator==(const Attributes&) const = default;
+};
+
+namespace detail
+{
+constexpr std::uint32_t pack_attributes(const Attributes& attributes)
+{
+    return static_cast<std::uint32_t>(attributes.foreground)
+         | static_cast<std::uint32_t>(attributes.background) << 4
+         | std::uint32_t { attributes.bold } << 8
+         | std::uint32_t { attributes.underline } << 9
+         | std::uint32_t { attributes.reverse } << 10;
+}
+
+constexpr Attributes unpack_attributes(std::uint32_t bits)
+{
+    return { static_cast<Color>(bits & 0xf), static_cast<Color>(bits >> 4 & 0xf),
+             (bits >> 8 & 1) != 0, (bits >> 9 & 1) != 0, (bits >> 10 & 1) != 0 };
+}
+} // namespace detail
+
+/*
+ * A Unicode code point (21 bits) and all Attributes (11 bits) in 32 bits.
+ * Cells compare as one word, so damage detection stays a single compare.
+ */
+class Cell32
+{
+public:
+    constexpr Cell32(char32_t glyph = U' ', const Attributes& attributes = {})
+    : bits_ { (static_cast<std::uint32_t>(glyph) & glyph_mask) | detail::pack_attributes(attributes) << glyph_bits }
+    {}
+    constexpr Cell32(char glyph) : Cell32 { static_cast<char32_t>(static_cast<unsigned char>(glyph)) } {}
+
+    constexpr char32_t glyph() const { return bits_ & glyph_mask; }
+    constexpr Attributes attributes() const { return detail::unpack_attributes(bits_ >> glyph_bits); }
+
+    // The same attributes with another glyph, for painting text in a style
+    constexpr Cell32 with_glyph(char glyph) const
+    {
+        return from_bits((bits_ & ~glyph_mask) | static_cast<unsigned char>(glyph));
+    }
+
+    constexpr std::uint32_t bits() const { return bits_; }
+
+    constexpr bool operator==(const Cell32&) const = default;
+
+private:
+    static constexpr unsigned       glyph_bits = 21;
+    static constexpr std::uint32_t  glyph_mask = (1u << glyph_bits) - 1;
+
+    static constexpr Cell32 from_bits(std::uint32_t bits)
+    {
+        Cell32 cell {};
+        cell.bits_ = bits;
+        return cell;
+    }
+
+    std::uint32_t bits_;
+};
+
+/*
+ * An 8 bit glyph (ASCII, or any single byte encoding) and the two colors in
+ * 16 bits. Styles other than color do not fit and read back as unset.
+ */
+class Cell16
+{
+public:
+    constexpr Cell16(char glyph = ' ', const Attributes& attributes = {})
+    : bits_ { static_cast<std::uint16_t>(static_cast<unsigned char>(glyph)
+                                         | (detail::pack_attributes(attributes) & 0xff) << 8) }
+    {}
+
+    constexpr char32_t glyph() const { return bits_ & 0xff; }
+    constexpr Attributes attributes() const { return detail::unpack_attributes(bits_ >> 8); }
+
+    constexpr Cell16 with_glyph(char glyph) const
+    {
+        Cell16 cell { *this };
+        cell.bits_ = static_cast<std::uint16_t>((bits_ & 0xff00) | static_cast<unsigned char>(glyph));
+        return cell;
+    }
+
+    constexpr std::uint16_t bits() const { return bits_; }
+
+    constexpr bool operator==(const Cell16&) const = default;
+
+private:
+    std::uint16_t bits_;
+};
+
+static_assert(sizeof(Cell32) == 4 && sizeof(Cell16) == 2);
+
+/*
+ * Appends the SGR sequence switching the terminal to `attributes`. It always
+ * starts from a reset, so the result does not depend on the attributes before.
+ */
+inline void append_sgr(std::string& out, const Attributes& attributes)
+{
+    const auto color = [&out](Color color, int normal, int bright) {
+        const auto index = static_cast<int>(color);
+        if (index == 0) return;
+        const auto code = index <= 8 ? normal + index - 1 : bright + index - 8;
+        out += ';';
+        out += std::to_string(code);
+    };
+
+    out += "\x1b[0";
+    if (attributes.bold) out += ";1";
+    if (attributes.underline) out += ";4";
+    if (attributes.reverse) out += ";7";
+    color(attributes.foreground, 30, 90);
+    color(attributes.background, 40, 100);
+    out += 'm';
+}
+
+// Appends `glyph` encoded as UTF-8
+inline void append_utf8(std::string& out, char32_t glyph)
+{
+    const auto byte = [&out](std::uint32_t value) { out += static_cast<char>(value); };
+    const auto code = static_cast<std::uint32_t>(glyph);
+    if (code < 0x80) byte(code);
+    else if (code < 0x800) { byte(0xc0 | code >> 6); byte(0x80 | (code & 0x3f)); }
+    else if (code < 0x10000) { byte(0xe0 | code >> 12); byte(0x80 | (code >> 6 & 0x3f)); byte(0x80 | (code & 0x3f)); }
+    else { byte(0xf0 | code >> 18); byte(0x80 | (code >> 12 & 0x3f)); byte(0x80 | (code >> 6 & 0x3f)); byte(0x80 | (code & 0x3f)); }
+}
+
+} // namespace val
@@ -0,0 +1,69 @@
+//
+//  containers.hpp
+//  playground
+//
+//  Independent sub-stages, laid out in parallel.
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "typedefs.hpp"
+#include "batch.hpp"
+#include "display_list.hpp"
+#include "pool.hpp"
+
+namespace val
+{
+
+/*
+ * A panel/column of the screen: a sub-stage with its own director, actor
+ * measure and scripts. Nothing inside a container depends on its siblings or
+ * its children, so every container of a tree can be laid out at the same time.
+ *
+ * Children paint on top of their parent, in order. As with any Set, the
+ * stacking directors start at the layout's offsets, not at the stage origin.
+ */
+struct Container
+{
+    const Stage                 stage;
+    const StageLayout           layout {};
+    const Director              director;
+    const measure_fn            measure;
+    std::vector<std::string>    scripts {};
+    std::vector<Container>      children {};
+};
+
+namespace detail
+{
+inline void flatten(const Container& container, std::vector<const Container*>& into)
+{
+    into.push_back(&container);
+    for (const auto& child : container.children) flatten(child, into);
+}
+} // namespace detail
+
+/*
+ * Lays out every container of the tree on the pool and merges their display
+ * lists in pre-order (parent, then children in order). The merge order does
+ * not depend on which thread finished first, so the result is identical for
+ * any number of threads.
+ */
+inline void layout_containers(const Container& root, ThreadPool& pool, DisplayList& into)
+{
+    std::vector<const Container*> containers {};
+    detail::flatten(root, containers);
+
+    std::vector<DisplayList> parts(containers.size());
+    pool.parallel_for(containers.size(), [&](size_t idx) {
+        const auto& container = *containers[idx];
+        produce_display_list(container.stage, container.layout, container.director, container.measure,
+                             container.scripts, parts[idx]);
+    });
+
+    for (const auto& part : parts) into.append(part);
+}
+
+} // namespace val
@@ -17,14 +17,25 @@ constexpr val::Direction Strict(const float& val) { return val::def{val}; }
 
 namespace stack
 {
-val::instruct_fn horizontal_next = [](const val::Stage& stage, const val::StageLayout& layout) -> val::Instruction {
+/*
+ * The stacking rules themselves, as plain (stateless, constexpr) lambdas.
+ * They are wrapped into std::function directors below for runtime-configured
+ * crews, and used as-is by the statically typed directors in `statically`.
+ */
+namespace kernel
+{
+// Strict and Lenient for any coordinate type; integer sums are narrowed back to it
+template<class T> constexpr val::BasicDirection<T> strict(auto value) { return val::basic_def<T>{static_cast<T>(value)}; }
+template<class T> constexpr val::BasicDirection<T> lenient(auto value) { return val::basic_lnt<T>{static_cast<T>(value)}; }
+
+inline constexpr auto horizontal_next = []<class T>(const val::BasicStage<T>& stage, const val::BasicStageLayout<T>& layout) -> val::BasicInstruction<T> {
     return {
-        { Strict(layout.x_offset + layout.horizontal_margin), Lenient(stage.right) },
-        { Strict(stage.top), Lenient(stage.bottom) }
+        { strict<T>(layout.x_offset + layout.horizontal_margin), lenient<T>(stage.right) },
+        { strict<T>(stage.top), lenient<T>(stage.bottom) }
     };
 };
 
-val::adjust_fn horizontal_adjust = [](const val::Stage&, const val::performance& perf, const val::StageLayout& layout) -> val::StageLayout {
+inline constexpr auto horizontal_adjust = []<class T>(const val::BasicStage<T>&, const val::BasicStage<T>& perf, const val::BasicStageLayout<T>& layout) -> val::BasicStageLayout<T> {
     auto next = layout;
     next.x_offset += (perf.right - perf.left) + 1 +layout.horizontal_margin;
     next.x_size += perf.left + perf.right;
@@ -32,14 +43,14 @@ val::adjust_fn horizontal_adjust = [](const val::Stage&, const val::performance&
     return next;
 };
 
-val::instruct_fn vertical_next = [](const val::Stage& stage, const val::StageLayout& layout) -> val::Instruction {
+inline constexpr auto vertical_next = []<class T>(const val::BasicStage<T>& stage, const val::BasicStageLayout<T>& layout) -> val::BasicInstruction<T> {
     return {
-        { Strict(stage.left), Lenient(stage.right) },
-        { Strict(layout.y_offset + layout.vertical_margin), Lenient(stage.bottom) },
+        { strict<T>(stage.left), lenient<T>(stage.right) },
+        { strict<T>(layout.y_offset + layout.vertical_margin), lenient<T>(stage.bottom) },
     };
 };
 
-val::adjust_fn vertical_adjust = [](const val::Stage&, const val::performance& perf, const val::StageLayout& layout) -> val::StageLayout {
+inline constexpr auto vertical_adjust = []<class T>(const val::BasicStage<T>&, const val::BasicStage<T>& perf, const val::BasicStageLayout<T>& layout) -> val::BasicStageLayout<T> {
     auto next = layout;
     next.y_offset += (perf.bottom - perf.top) + 1 + layout.vertical_margin;
     next.y_size += perf.top + perf.bottom + 1;
@@ -47,31 +58,40 @@ val::adjust_fn vertical_adjust = [](const val::Stage&, const val::performance& p
     return next;
 };
 
-
-val::instruct_fn magically_next = [](const val::Stage& stage, const val::StageLayout& layout) -> val::Instruction {
-    switch (stage.aspect())
-    {
-        case val::Stage::Aspect::horizontal:
-            return horizontal_next(stage, layout);
-        case val::Stage::Aspect::vertical:
-            return vertical_next(stage, layout);
-    };
+inline constexpr auto magically_next = []<class T>(const val::BasicStage<T>& stage, const val::BasicStageLayout<T>& layout) -> val::BasicInstruction<T> {
+    if (stage.aspect() == val::BasicStage<T>::Aspect::horizontal) return horizontal_next(stage, layout);
+    return vertical_next(stage, layout);
 };
 
-val::adjust_fn magically_adjust = [](const val::Stage& stage, const val::performance& perf, const val::StageLayout& layout) -> val::StageLayout {
-    switch (stage.aspect())
-    {
-        case val::Stage::Aspect::horizontal:
-            return horizontal_adjust(stage, perf, layout);
-        case val::Stage::Aspect::vertical:
-            return vertical_adjust(stage, perf, layout);
-    };
+inline constexpr auto magically_adjust = []<class T>(const val::BasicStage<T>& stage, const val::BasicStage<T>& perf, const val::BasicStageLayout<T>& layout) -> val::BasicStageLayout<T> {
+    if (stage.aspect() == val::BasicStage<T>::Aspect::horizontal) return horizontal_adjust(stage, perf, layout);
+    return vertical_adjust(stage, perf, layout);
 };
+} // namespace kernel
 
-static const val::Director horizontally {horizontal_next, horizontal_adjust};
-static const val::Director vertically   {vertical_next,   vertical_adjust};
-static const val::Director magically    {magically_next,  magically_adjust};
-}
+val::instruct_fn horizontal_next = kernel::horizontal_next;
+val::adjust_fn horizontal_adjust = kernel::horizontal_adjust;
 
-} // namespace dir
+val::instruct_fn vertical_next = kernel::vertical_next;
+val::adjust_fn vertical_adjust = kernel::vertical_adjust;
 
+val::instruct_fn magically_next = kernel::magically_next;
+val::adjust_fn magically_adjust = kernel::magically_adjust;
+
+static const val::Director horizontally {horizontal_next, horizontal_adjust, "horizontally"};
+static const val::Director vertically   {vertical_next,   vertical_adjust,   "vertically"};
+static const val::Director magically    {magically_next,  magically_adjust,  "magically",
+    [](const val::Stage& stage) -> const val::Director* {
+        return stage.aspect() == val::Stage::Aspect::horizontal ? &horizontally : &vertically;
+    }};
+
+// Statically typed counterparts, for crews known at compile time
+namespace statically
+{
+inline constexpr val::BasicDirector horizontally {kernel::horizontal_next, kernel::horizontal_adjust, "statically::horizontally"};
+inline constexpr val::BasicDirector vertically   {kernel::vertical_next,   kernel::vertical_adjust,   "statically::vertically"};
+inline constexpr val::BasicAspectDirector magically {horizontally, vertically, "statically::magically"};
+} // namespace statically
+} // namespace stack
+
+} // namespace dir
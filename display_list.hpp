@@ -0,0 +1,144 @@
+//
+//  display_list.hpp
+//  playground
+//
+//  Retained paint commands, decoupled from the layout that produced them.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "typedefs.hpp"
+#include "actors.hpp"
+#include "raster.hpp"
+#include "batch.hpp"
+
+namespace val
+{
+
+/*
+ * One paint step: what to draw, the frame it was placed in and the range of
+ * its text in the owning DisplayList's text arena. Commands are plain data,
+ * so a list can be kept between frames, compared and replayed.
+ */
+struct DisplayCommand
+{
+    enum class Kind : std::uint8_t
+    {
+        button
+    };
+
+    Kind            kind;
+    float           left;
+    float           right;
+    float           top;
+    float           bottom;
+    std::uint32_t   text_offset;
+    std::uint32_t   text_length;
+
+    constexpr Stage frame() const { return { left, right, top, bottom }; }
+
+    bool operator==(const DisplayCommand&) const = default;
+};
+
+struct DisplayList
+{
+    std::pmr::vector<DisplayCommand>    commands;
+    std::pmr::string                    text;
+
+    explicit DisplayList(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+    : commands { resource }, text { resource }
+    {}
+
+    std::pmr::memory_resource* resource() const { return commands.get_allocator().resource(); }
+
+    size_t size() const { return commands.size(); }
+
+    void clear()
+    {
+        commands.clear();
+        text.clear();
+    }
+
+    void push_button(const Stage& frame, std::string_view script)
+    {
+        commands.push_back({
+            DisplayCommand::Kind::button,
+            frame.left, frame.right, frame.top, frame.bottom,
+            static_cast<std::uint32_t>(text.size()),
+            static_cast<std::uint32_t>(script.size())
+        });
+        text.append(script);
+    }
+
+    // Appends the commands of `other`, rebasing their text into this arena
+    void append(const DisplayList& other)
+    {
+        const auto base = static_cast<std::uint32_t>(text.size());
+        commands.reserve(commands.size() + other.commands.size());
+        for (auto command : other.commands)
+        {
+            command.text_offset += base;
+            commands.push_back(command);
+        }
+        text.append(other.text);
+    }
+
+    std::string_view text_of(const DisplayCommand& command) const
+    {
+        return std::string_view { text }.substr(command.text_offset, command.text_length);
+    }
+
+    bool operator==(const DisplayList&) const = default;
+};
+
+// Records one button command per placed stage of a batch
+template<Scripts TScripts>
+void record_batch(const SceneBatch& batch, const TScripts& scripts, DisplayList& into)
+{
+    into.commands.reserve(into.commands.size() + batch.size());
+    for (size_t idx { 0 }; idx < batch.size(); ++idx)
+        into.push_button(batch.stage(idx), scripts[batch.script_index[idx]]);
+}
+
+// Replays every command of the list onto the screen, in order, skipping
+// commands whose frame lies entirely off screen
+inline void rasterize(const DisplayList& list, Screen& screen)
+{
+    for (const auto& command : list.commands)
+    {
+        if (!raster::visible(command.frame(), screen.buffer)) continue;
+        switch (command.kind)
+        {
+            case DisplayCommand::Kind::button:
+                paint_button(screen, command.frame(), list.text_of(command));
+                break;
+        }
+    }
+}
+
+} // namespace val
+
+/*
+ * Lays out the scripts like layout_batch and records the result as a display
+ * list instead of paint closures. Returns the final StageLayout.
+ *
+ * All intermediate storage comes from the list's memory resource, so with a
+ * list backed by a val::FrameArena a frame needs no heap allocations.
+ */
+const auto produce_display_list =
+[]<class TDirector, val::Measures TMeasure, val::Scripts TScripts>
+(const val::Stage& stage, val::StageLayout layout, const TDirector& director, const TMeasure& measure,
+ const TScripts& scripts, val::DisplayList& into) -> val::StageLayout
+{
+    val::SceneBatch batch { into.resource() };
+    const auto final_layout = layout_batch(stage, layout, director, measure, scripts, batch);
+    val::record_batch(batch, scripts, into);
+    return final_layout;
+};
@@ -0,0 +1,182 @@
+//
+//  flow.hpp
+//  playground
+//
+//  Wrapping and grid layouts, solved in one pass over a batch.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <span>
+#include <string>
+
+#include "typedefs.hpp"
+#include "directors.hpp"
+#include "batch.hpp"
+#include "instrument.hpp"
+
+namespace val
+{
+
+// How items take the width a flow offers them
+enum class ItemWidth
+{
+    fill,       // exactly as wide as offered (dir::Strict)
+    natural,    // up to as wide as offered (dir::Lenient)
+};
+
+/*
+ * The widths a flow gives its items. Every item is offered at least min_width
+ * and at most max_width, and never more than the stage is wide; so an item
+ * too wide for the stage gets a row of its own, cut to the stage.
+ */
+struct ItemConstraints
+{
+    ItemWidth   width       { ItemWidth::fill };
+    float       min_width   { 0 };
+    float       max_width   { std::numeric_limits<float>::infinity() };
+
+    // `extent` within the constraints and `available`
+    constexpr float clamp(float extent, float available) const
+    {
+        const float low  = std::min(min_width, available);
+        const float high = std::max(low, std::min(max_width, available));
+        return std::clamp(extent, low, high);
+    }
+};
+
+/*
+ * Fills rows left to right and wraps to the next row when an item no longer
+ * fits, like a wrapping flexbox. One pass measures every item at its natural
+ * width, clamped to the constraints, a second breaks the rows and places each
+ * item in its share of its row: with ItemWidth::fill the leftover space of the
+ * row is shared out (in whole cells) among its items, up to max_width, with
+ * ItemWidth::natural items keep their natural width (and are stretched only to
+ * min_width).
+ *
+ * Spacing follows the stacking directors: items are separated by one cell plus
+ * horizontal_margin, rows by one cell plus vertical_margin, and the first row
+ * starts at layout.y_offset. Placed stages are appended to `into` with their
+ * index in `scripts`; the returned layout has y_offset past the last row, for
+ * chaining. That is two measures per item, however the rows break.
+ */
+template<Measures TMeasure, Scripts TScripts>
+StageLayout layout_flex_wrap(const Stage& stage, StageLayout layout, const TMeasure& measure,
+                             const TScripts& scripts, SceneBatch& into, const ItemConstraints& constraints = {})
+{
+    THEATER_SCOPE(layout, "flex_wrap");
+    const size_t first = into.size();
+    const float gap = 1 + layout.horizontal_margin;
+    const float available = stage.right - stage.left;
+    const bool fill = constraints.width == ItemWidth::fill;
+
+    // Natural sizes, all measured against the full width of the stage
+    const Instruction natural = dir::stack::kernel::vertical_next(stage, layout);
+    into.reserve(first + scripts.size());
+    for (size_t idx { 0 }; idx < scripts.size(); ++idx) into.push_back(measure(natural, scripts[idx]), idx);
+
+    float top = layout.y_offset + layout.vertical_margin;
+    size_t begin { 0 };
+    while (begin < scripts.size())
+    {
+        // The row is [begin, end): as many items as fit, and never none
+        const auto natural_extent = [&](size_t idx) { return into.right[first + idx] - into.left[first + idx]; };
+        const auto extent = [&](size_t idx) { return constraints.clamp(natural_extent(idx), available); };
+        float used = extent(begin);
+        size_t end = begin + 1;
+        while (end < scripts.size() && stage.left + used + gap + extent(end) <= stage.right)
+        {
+            used += gap + extent(end);
+            ++end;
+        }
+
+        const size_t count = end - begin;
+        const float leftover = fill ? std::max(0.0f, std::floor(available - used)) : 0.0f;
+        const float share = std::floor(leftover / static_cast<float>(count));
+        size_t remainder = static_cast<size_t>(leftover - share * static_cast<float>(count));
+
+        float x = stage.left;
+        float height {0};
+        for (size_t idx { begin }; idx < end; ++idx)
+        {
+            const float width = std::min(extent(idx) + share + (remainder > 0 ? 1 : 0), std::max(extent(idx), constraints.max_width));
+            if (remainder > 0) --remainder;
+
+            // A natural item below min_width is held to it
+            const bool exact = fill || natural_extent(idx) < width;
+            const Instruction offered {
+                { dir::Strict(x), exact ? dir::Strict(x + width) : dir::Lenient(x + width) },
+                { dir::Strict(top), dir::Lenient(stage.bottom) }
+            };
+            const auto placed = measure(offered, scripts[idx]);
+            into.assign(first + idx, placed, idx);
+            height = std::max(height, placed.bottom - placed.top);
+            x += width + gap;
+        }
+
+        top += height + 1 + layout.vertical_margin;
+        begin = end;
+    }
+
+    layout.y_offset = top - layout.vertical_margin;
+    return layout;
+}
+
+/*
+ * Lays items out in `columns` equally wide columns, row by row. Column bounds
+ * only depend on the stage, so every item is measured exactly once, directly
+ * in its cell; rows are as tall as their tallest item. With ItemWidth::fill
+ * items fill their column up to max_width, with ItemWidth::natural they are at
+ * most as wide as it; the rare natural item below min_width is measured again
+ * at that width. min_width never widens a column: it is capped at the column.
+ *
+ * Spacing, placement in `into` and the returned layout are as for
+ * layout_flex_wrap.
+ */
+template<Measures TMeasure, Scripts TScripts>
+StageLayout layout_grid(const Stage& stage, StageLayout layout, const TMeasure& measure,
+                        const TScripts& scripts, size_t columns, SceneBatch& into, const ItemConstraints& constraints = {})
+{
+    THEATER_SCOPE(layout, "grid");
+    columns = std::max<size_t>(columns, 1);
+    const float gap = 1 + layout.horizontal_margin;
+    const float available = stage.right - stage.left - gap * static_cast<float>(columns - 1);
+    const float column_width = std::max(1.0f, std::floor(available / static_cast<float>(columns)));
+    const float item_width = constraints.clamp(column_width, column_width);
+    const float min_width = std::min(constraints.min_width, item_width);
+    const bool fill = constraints.width == ItemWidth::fill;
+
+    float top = layout.y_offset + layout.vertical_margin;
+    float height {0};
+    into.reserve(into.size() + scripts.size());
+    for (size_t idx { 0 }; idx < scripts.size(); ++idx)
+    {
+        const size_t column = idx % columns;
+        if (column == 0 && idx > 0)
+        {
+            top += height + 1 + layout.vertical_margin;
+            height = 0;
+        }
+
+        const float x = stage.left + static_cast<float>(column) * (column_width + gap);
+        const auto offered = [&](Direction high) {
+            return Instruction { { dir::Strict(x), high }, { dir::Strict(top), dir::Lenient(stage.bottom) } };
+        };
+        const auto placed = [&] {
+            const auto first_fit = measure(offered(fill ? dir::Strict(x + item_width) : dir::Lenient(x + item_width)), scripts[idx]);
+            if (first_fit.right - first_fit.left >= min_width) return first_fit;
+            return measure(offered(dir::Strict(x + min_width)), scripts[idx]);
+        }();
+        into.push_back(placed, idx);
+        height = std::max(height, placed.bottom - placed.top);
+    }
+
+    if (!scripts.empty()) top += height + 1 + layout.vertical_margin;
+    layout.y_offset = top - layout.vertical_margin;
+    return layout;
+}
+
+} // namespace val
@@ -0,0 +1,105 @@
+//
+//  incremental.hpp
+//  playground
+//
+//  Relayout of a list where only some scripts changed since the last run.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "typedefs.hpp"
+#include "batch.hpp"
+
+namespace val
+{
+
+/*
+ * Keeps the StageLayout every actor was placed with (its checkpoint), next to
+ * the placed stages. With stacking directors an actor's placement depends only
+ * on the actors before it, so after a change the layout restarts at the
+ * earliest changed script and stops as soon as an adjusted layout matches the
+ * checkpoint of the previous run, skipping ahead to the next changed script.
+ *
+ * checkpoints()[i] is the layout actor i was placed with, and
+ * checkpoints().back() the layout after the last actor.
+ */
+template<class TDirector, Measures TMeasure>
+class IncrementalLayout
+{
+public:
+    IncrementalLayout(const Stage& stage, const StageLayout& initial, TDirector director, TMeasure measure)
+    : stage_ { stage }, director_ { std::move(director) }, measure_ { std::move(measure) }, checkpoints_ { initial }
+    {}
+
+    // Lays out every script from scratch
+    template<Scripts TScripts>
+    size_t layout(const TScripts& scripts)
+    {
+        scenes_.clear();
+        checkpoints_.resize(1);
+        return relayout(scripts, {});
+    }
+
+    /*
+     * Brings the layout up to date with `scripts`, of which only the ones at
+     * `changed` differ from the previous run (a change in length marks the
+     * tail as changed as well). Returns the number of actors laid out again.
+     */
+    template<Scripts TScripts>
+    size_t relayout(const TScripts& scripts, std::span<const size_t> changed)
+    {
+        const size_t count    = scripts.size();
+        const size_t retained = std::min(scenes_.size(), count);
+
+        std::vector<size_t> dirty {};
+        dirty.reserve(changed.size() + 1);
+        for (const auto idx : changed) if (idx < retained) dirty.push_back(idx);
+        if (retained < count) dirty.push_back(retained);
+        std::sort(dirty.begin(), dirty.end());
+        dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+
+        scenes_.resize(count);
+        checkpoints_.resize(count + 1);
+
+        size_t relaid { 0 };
+        auto next_dirty = dirty.begin();
+        while (next_dirty != dirty.end())
+        {
+            size_t idx = *next_dirty;
+            for (; idx < count; ++idx)
+            {
+                const auto& before = checkpoints_[idx];
+                const auto placed  = measure_(director_.instruct(stage_, before), scripts[idx]);
+                const auto after   = director_.adjust(stage_, placed, before);
+                scenes_.assign(idx, placed, idx);
+                ++relaid;
+
+                // Past the retained prefix (or the tail) there is nothing to converge with
+                const bool converged = idx + 1 < retained && after == checkpoints_[idx + 1];
+                checkpoints_[idx + 1] = after;
+                if (converged) break;
+            }
+            next_dirty = std::upper_bound(next_dirty, dirty.end(), idx);
+        }
+        return relaid;
+    }
+
+    const SceneBatch& scenes() const { return scenes_; }
+    const std::vector<StageLayout>& checkpoints() const { return checkpoints_; }
+    const StageLayout& final_layout() const { return checkpoints_.back(); }
+
+private:
+    const Stage                 stage_;
+    const TDirector             director_;
+    const TMeasure              measure_;
+
+    SceneBatch                  scenes_ {};
+    std::vector<StageLayout>    checkpoints_ {};
+};
+
+} // namespace val
@@ -0,0 +1,259 @@
+//
+//  instrument.hpp
+//  playground
+//
+//  Optional timing and counting of the layout and paint phases.
+//
+
+#pragma once
+
+/*
+ * Build with -DTHEATER_INSTRUMENT=1 to enable. Otherwise THEATER_SCOPE and
+ * THEATER_COUNT expand to nothing and the producers carry no trace of it.
+ *
+ * Events go to the sink installed with val::instrument::set_sink (none by
+ * default, which records nothing). Sinks may be called from several threads.
+ */
+#ifndef THEATER_INSTRUMENT
+#define THEATER_INSTRUMENT 0
+#endif
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace val::instrument
+{
+
+enum class Phase : std::uint8_t
+{
+    layout,     // produce_scenes as a whole
+    instruct,   // director.instruct
+    perform,    // performer.perfom
+    adjust,     // director.adjust
+    paint,      // paint closures / display list replay
+    output      // writing the screen out
+};
+
+constexpr const char* name(Phase phase)
+{
+    switch (phase)
+    {
+        case Phase::layout:     return "layout";
+        case Phase::instruct:   return "instruct";
+        case Phase::perform:    return "perform";
+        case Phase::adjust:     return "adjust";
+        case Phase::paint:      return "paint";
+        case Phase::output:     return "output";
+    }
+    return "unknown";
+}
+
+// A finished timed scope; `tag` tells which director (or other origin) it ran for
+struct Event
+{
+    Phase           phase;
+    const char*     tag;
+    std::uint64_t   start_ns;
+    std::uint64_t   duration_ns;
+    std::uint32_t   thread;
+};
+
+class Sink
+{
+public:
+    virtual ~Sink() = default;
+    virtual void record(const Event& event) = 0;
+    virtual void count(const char* /* counter */, std::int64_t /* delta */) {}
+};
+
+inline std::atomic<Sink*> active_sink { nullptr };
+
+inline void set_sink(Sink* sink) { active_sink.store(sink, std::memory_order_release); }
+
+inline std::uint64_t now_ns()
+{
+    static const auto epoch = std::chrono::steady_clock::now();
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+}
+
+inline std::uint32_t thread_index()
+{
+    static std::atomic<std::uint32_t> next { 0 };
+    thread_local const std::uint32_t index = next.fetch_add(1);
+    return index;
+}
+
+inline void count(const char* counter, std::int64_t delta)
+{
+    if (auto* sink = active_sink.load(std::memory_order_acquire)) sink->count(counter, delta);
+}
+
+class ScopedTimer
+{
+public:
+    ScopedTimer(Phase phase, const char* tag)
+    : sink_ { active_sink.load(std::memory_order_acquire) }, phase_ { phase }, tag_ { tag }, start_ { sink_ ? now_ns() : 0 }
+    {}
+
+    ~ScopedTimer()
+    {
+        if (sink_) sink_->record({ phase_, tag_, start_, now_ns() - start_, thread_index() });
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Sink* const         sink_;
+    const Phase         phase_;
+    const char* const   tag_;
+    const std::uint64_t start_;
+};
+
+/*
+ * Aggregates durations per (phase, tag) into power-of-two buckets, plus
+ * count/total/min/max, and sums counters.
+ */
+class HistogramSink : public Sink
+{
+public:
+    struct Histogram
+    {
+        std::uint64_t                   samples {0};
+        std::uint64_t                   total_ns {0};
+        std::uint64_t                   min_ns {UINT64_MAX};
+        std::uint64_t                   max_ns {0};
+        std::array<std::uint64_t, 64>   buckets {}; // bucket b: [2^b, 2^(b+1)) ns
+
+        double mean_ns() const { return samples ? static_cast<double>(total_ns) / static_cast<double>(samples) : 0.0; }
+    };
+
+    void record(const Event& event) override
+    {
+        std::lock_guard lock { mutex_ };
+        auto& histogram = histograms_[{ event.phase, event.tag }];
+        ++histogram.samples;
+        histogram.total_ns += event.duration_ns;
+        histogram.min_ns = std::min(histogram.min_ns, event.duration_ns);
+        histogram.max_ns = std::max(histogram.max_ns, event.duration_ns);
+        ++histogram.buckets[bucket_of(event.duration_ns)];
+    }
+
+    void count(const char* counter, std::int64_t delta) override
+    {
+        std::lock_guard lock { mutex_ };
+        counters_[counter] += delta;
+    }
+
+    Histogram histogram(Phase phase, const std::string& tag) const
+    {
+        std::lock_guard lock { mutex_ };
+        const auto found = histograms_.find({ phase, tag });
+        return found == histograms_.end() ? Histogram {} : found->second;
+    }
+
+    std::int64_t counter(const std::string& counter) const
+    {
+        std::lock_guard lock { mutex_ };
+        const auto found = counters_.find(counter);
+        return found == counters_.end() ? 0 : found->second;
+    }
+
+    void write_summary(std::ostream& out) const
+    {
+        std::lock_guard lock { mutex_ };
+        for (const auto& [key, histogram] : histograms_)
+        {
+            out << name(key.first) << '[' << key.second << "] samples=" << histogram.samples
+                << " mean=" << histogram.mean_ns() << "ns min=" << histogram.min_ns << "ns max=" << histogram.max_ns << "ns\n";
+        }
+        for (const auto& [counter, value] : counters_) out << counter << '=' << value << '\n';
+    }
+
+private:
+    static size_t bucket_of(std::uint64_t ns)
+    {
+        size_t bucket { 0 };
+        while (ns > 1 && bucket < 63) { ns >>= 1; ++bucket; }
+        return bucket;
+    }
+
+    mutable std::mutex                                      mutex_ {};
+    std::map<std::pair<Phase, std::string>, Histogram>      histograms_ {};
+    std::map<std::string, std::int64_t>                     counters_ {};
+};
+
+// Keeps every event, for export in the Chrome trace event format (chrome://tracing, Perfetto)
+class ChromeTraceSink : public Sink
+{
+public:
+    void record(const Event& event) override
+    {
+        std::lock_guard lock { mutex_ };
+        events_.push_back(event);
+    }
+
+    void count(const char* counter, std::int64_t delta) override
+    {
+        std::lock_guard lock { mutex_ };
+        counters_.push_back({ counter, totals_[counter] += delta, now_ns() });
+    }
+
+    void write_json(std::ostream& out) const
+    {
+        std::lock_guard lock { mutex_ };
+        out << "{\"traceEvents\":[";
+        bool first { true };
+        const auto separate = [&] { if (!first) out << ','; first = false; };
+        for (const auto& event : events_)
+        {
+            separate();
+            out << "{\"name\":\"" << name(event.phase) << "\",\"cat\":\"" << event.tag << "\",\"ph\":\"X\",\"ts\":"
+                << static_cast<double>(event.start_ns) / 1000.0 << ",\"dur\":" << static_cast<double>(event.duration_ns) / 1000.0
+                << ",\"pid\":1,\"tid\":" << event.thread << '}';
+        }
+        for (const auto& sample : counters_)
+        {
+            separate();
+            out << "{\"name\":\"" << sample.counter << "\",\"ph\":\"C\",\"ts\":" << static_cast<double>(sample.at_ns) / 1000.0
+                << ",\"pid\":1,\"args\":{\"value\":" << sample.value << "}}";
+        }
+        out << "]}\n";
+    }
+
+private:
+    struct CounterSample
+    {
+        std::string     counter;
+        std::int64_t    value;
+        std::uint64_t   at_ns;
+    };
+
+    mutable std::mutex                      mutex_ {};
+    std::vector<Event>                      events_ {};
+    std::vector<CounterSample>              counters_ {};
+    std::map<std::string, std::int64_t>     totals_ {};
+};
+
+} // namespace val::instrument
+
+#define THEATER_CONCAT_IMPL(a, b) a##b
+#define THEATER_CONCAT(a, b) THEATER_CONCAT_IMPL(a, b)
+
+#if THEATER_INSTRUMENT
+#define THEATER_SCOPE(phase, tag) \
+    const ::val::instrument::ScopedTimer THEATER_CONCAT(theater_scope_, __LINE__) { ::val::instrument::Phase::phase, (tag) }
+#define THEATER_COUNT(counter, delta) ::val::instrument::count((counter), (delta))
+#else
+#define THEATER_SCOPE(phase, tag) static_cast<void>(0)
+#define THEATER_COUNT(counter, delta) static_cast<void>(0)
+#endif
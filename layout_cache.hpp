@@ -0,0 +1,225 @@
+//
+//  layout_cache.hpp
+//  playground
+//
+//  Memoized layouts of whole frames.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <span>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+#include "typedefs.hpp"
+#include "producers.hpp"
+#include "batch.hpp"
+#include "display_list.hpp"
+#include "instrument.hpp"
+
+namespace val
+{
+
+/*
+ * Remembers where the scenes of a frame were placed, keyed on everything the
+ * placement depends on: the stage, the initial StageLayout, the director, the
+ * measure and the measurements of the scripts. Frames that are layout-identical
+ * to a recent one, whatever text they show, get its stages back without
+ * running the director.
+ *
+ * A script's measurement is the extent (width and height) the measure gives
+ * it for the director's first instruction. That stands in for its text on the
+ * assumption that scripts measuring alike there measure alike under every
+ * later instruction, as with measures that only clamp a size of the script's
+ * own to the space offered (measure_button). Directors and measures are told
+ * apart by type and address: keep them alive, and unchanged, as long as the
+ * cache. Keys are fingerprinted for lookup and compared in full on a hit, so
+ * a fingerprint collision costs a layout, never a wrong frame.
+ *
+ * At most `capacity` layouts are held; the least recently used one is evicted
+ * first. A layout returned by layout() stays valid until the next call. Hits
+ * and misses are counted here and reported as the "layout_cache_hits" /
+ * "layout_cache_misses" instrumentation counters. Not thread-safe: use one
+ * cache per thread.
+ */
+class LayoutCache
+{
+public:
+    struct Layout
+    {
+        SceneBatch      scenes {};
+        StageLayout     final_layout {};
+    };
+
+    explicit LayoutCache(size_t capacity = 16)
+    : capacity_ { std::max<size_t>(capacity, 1) }
+    {}
+
+    // The placed stages of the scripts, as layout_batch gives them
+    template<class TDirector, Measures TMeasure, Scripts TScripts>
+    const Layout& layout(const Stage& stage, const StageLayout& initial, const TDirector& director, const TMeasure& measure,
+                         const TScripts& scripts)
+    {
+        Key key { stage.left, stage.right, stage.top, stage.bottom, initial,
+                  &typeid(TDirector), &director, &typeid(TMeasure), &measure, std::move(spare_extents_) };
+        key.extents.clear();
+        key.extents.reserve(2 * scripts.size());
+        bind_director(director, stage, [&](const auto& bound) {
+            const Instruction first = bound.instruct(stage, initial);
+            for (const auto& script : scripts)
+            {
+                const auto measured = measure(first, script);
+                key.extents.push_back(measured.right - measured.left);
+                key.extents.push_back(measured.bottom - measured.top);
+            }
+        });
+        const std::uint64_t fingerprint = key.fingerprint();
+
+        if (const auto found = index_.find(fingerprint); found != index_.end())
+        {
+            const auto entry = found->second;
+            if (entry->key == key)
+            {
+                ++hits_;
+                THEATER_COUNT("layout_cache_hits", 1);
+                spare_extents_ = std::move(key.extents);
+                entries_.splice(entries_.begin(), entries_, entry);
+                return entry->layout;
+            }
+            entries_.erase(entry);
+            index_.erase(found);
+        }
+
+        ++misses_;
+        THEATER_COUNT("layout_cache_misses", 1);
+        if (entries_.size() >= capacity_)
+        {
+            index_.erase(entries_.back().fingerprint);
+            entries_.pop_back();
+        }
+
+        auto& entry = entries_.emplace_front(fingerprint, std::move(key));
+        const auto inserted = index_.emplace(fingerprint, entries_.begin()).first;
+        try
+        {
+            entry.layout.final_layout = layout_batch(stage, initial, director, measure, scripts, entry.layout.scenes);
+        }
+        catch (...)
+        {
+            index_.erase(inserted);
+            entries_.pop_front();
+            throw;
+        }
+        return entry.layout;
+    }
+
+    size_t hits() const { return hits_; }
+    size_t misses() const { return misses_; }
+    size_t size() const { return entries_.size(); }
+
+    void clear()
+    {
+        index_.clear();
+        entries_.clear();
+        hits_ = misses_ = 0;
+    }
+
+private:
+    struct Key
+    {
+        float                   left, right, top, bottom;
+        StageLayout             layout;
+        const std::type_info*   director_type;
+        const void*             director;
+        const std::type_info*   measure_type;
+        const void*             measure;
+        std::vector<float>      extents;    // width, height of every script
+
+        bool operator==(const Key& other) const
+        {
+            return left == other.left && right == other.right && top == other.top && bottom == other.bottom
+                && layout == other.layout && *director_type == *other.director_type && director == other.director
+                && *measure_type == *other.measure_type && measure == other.measure && extents == other.extents;
+        }
+
+        std::uint64_t fingerprint() const
+        {
+            std::uint64_t seed = director_type->hash_code();
+            const auto combine = [&seed](std::uint64_t value) {
+                seed ^= std::hash<std::uint64_t>{}(value) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+            };
+            const auto combine_pair = [&combine](float a, float b) {
+                combine(std::uint64_t { std::bit_cast<std::uint32_t>(a) } << 32 | std::bit_cast<std::uint32_t>(b));
+            };
+
+            combine(measure_type->hash_code());
+            combine(std::bit_cast<std::uintptr_t>(director));
+            combine(std::bit_cast<std::uintptr_t>(measure));
+            combine_pair(left, right);
+            combine_pair(top, bottom);
+            combine_pair(layout.x_offset, layout.y_offset);
+            combine_pair(layout.horizontal_margin, layout.vertical_margin);
+            combine_pair(layout.x_size, layout.y_size);
+            combine(extents.size());
+            for (size_t idx { 0 }; idx + 1 < extents.size(); idx += 2) combine_pair(extents[idx], extents[idx + 1]);
+            return seed;
+        }
+    };
+
+    struct Entry
+    {
+        Entry(std::uint64_t fingerprint, Key key) : fingerprint { fingerprint }, key { std::move(key) } {}
+
+        const std::uint64_t fingerprint;
+        const Key           key;
+        Layout              layout {};
+    };
+
+    const size_t                                                        capacity_;
+    std::list<Entry>                                                    entries_ {};    // most recently used first
+    std::unordered_map<std::uint64_t, typename std::list<Entry>::iterator> index_ {};
+    std::vector<float>                                                  spare_extents_ {};  // the last hit's, reused
+    size_t                                                              hits_ {0};
+    size_t                                                              misses_ {0};
+};
+
+/*
+ * produce_scenes through a layout cache, for sets whose actor is split: the
+ * actor's measure is what the cache keys on, and the scenes are painted from
+ * the cached stages with the current scripts. Returns the final StageLayout.
+ */
+template<class TDirector, class TMeasure, class TPaint, Scripts TScripts>
+StageLayout produce_scenes_cached(LayoutCache& cache, const BasicSet<BasicCrew<TDirector, BasicSplitActor<TMeasure, TPaint>>>& set,
+                                  const TScripts& scripts, TPerformanceBuffer& into)
+{
+    const auto& actor = set.crew.actor;
+    const auto& cached = cache.layout(set.stage, set.stage_layout, set.crew.director, actor.measure, scripts);
+    into.reserve(into.size() + cached.scenes.size());
+    for (size_t idx { 0 }; idx < cached.scenes.size(); ++idx)
+    {
+        const auto stage = cached.scenes.stage(idx);
+        const std::string_view script { scripts[cached.scenes.script_index[idx]] };
+        into.push_back({ stage, [paint = actor.paint, stage, script](Screen& screen) { paint(screen, stage, script); } });
+    }
+    return cached.final_layout;
+}
+
+// produce_display_list through a layout cache
+template<class TDirector, Measures TMeasure, Scripts TScripts>
+StageLayout produce_display_list_cached(LayoutCache& cache, const Stage& stage, const StageLayout& layout,
+                                        const TDirector& director, const TMeasure& measure,
+                                        const TScripts& scripts, DisplayList& into)
+{
+    const auto& cached = cache.layout(stage, layout, director, measure, scripts);
+    record_batch(cached.scenes, scripts, into);
+    return cached.final_layout;
+}
+
+} // namespace val
@@ -0,0 +1,130 @@
+//
+//  measure_cache.hpp
+//  playground
+//
+//  Memoized actor measurement.
+//
+
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+
+#include "typedefs.hpp"
+#include "packed.hpp"
+#include "scripts.hpp"
+
+namespace val
+{
+
+/*
+ * Wraps a measure function and remembers its results, keyed on the script's
+ * hash and the instruction (bounds and strictness). Frames that repeat text
+ * under the same constraints skip measuring entirely.
+ *
+ * The script text is kept with every entry and compared on lookup, so hash
+ * collisions cost a remeasure, never a wrong size. Texts are interned in the
+ * cache's own val::ScriptTable, so a script is copied once, however many
+ * instructions it is measured for. Once `capacity` entries are
+ * held the cache starts over. Not thread-safe: use one cache per thread.
+ *
+ * The instruction holds absolute positions, so in a stacked layout a script
+ * only hits where it sat in an earlier frame (repeated frames, scrolling
+ * back), not at every new position it is stacked at.
+ */
+template<Measures TMeasure>
+class MeasureCache
+{
+public:
+    explicit MeasureCache(TMeasure measure, size_t capacity = 1 << 16)
+    : measure_ { std::move(measure) }, capacity_ { capacity }
+    {}
+
+    Stage operator()(const Instruction& instruction, std::string_view script) const
+    {
+        const Key key { std::hash<std::string_view>{}(script), pack(instruction) };
+        if (const auto found = entries_.find(key); found != entries_.end() && found->second.script == script)
+        {
+            ++hits_;
+            return found->second.stage();
+        }
+
+        ++misses_;
+        const Stage stage = measure_(instruction, script);
+        if (entries_.size() >= capacity_)
+        {
+            entries_.clear();
+            texts_.clear();
+        }
+        entries_.insert_or_assign(key, Entry { texts_.intern(script), stage.left, stage.right, stage.top, stage.bottom });
+        return stage;
+    }
+
+    size_t hits() const { return hits_; }
+    size_t misses() const { return misses_; }
+    size_t size() const { return entries_.size(); }
+
+    void clear()
+    {
+        entries_.clear();
+        texts_.clear();
+        hits_ = misses_ = 0;
+    }
+
+private:
+    struct Key
+    {
+        size_t              script_hash;
+        PackedInstruction   constraint;
+
+        // Bitwise, so that NaN and signed zero constraints behave as keys
+        bool operator==(const Key& other) const
+        {
+            const auto same_axis = [](const PackedAxis& a, const PackedAxis& b) {
+                return std::bit_cast<std::uint32_t>(a.low) == std::bit_cast<std::uint32_t>(b.low)
+                    && std::bit_cast<std::uint32_t>(a.high) == std::bit_cast<std::uint32_t>(b.high)
+                    && a.strictness == b.strictness;
+            };
+            return script_hash == other.script_hash
+                && same_axis(constraint.horizontal, other.constraint.horizontal)
+                && same_axis(constraint.vertical, other.constraint.vertical);
+        }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const
+        {
+            size_t seed = key.script_hash;
+            const auto combine = [&seed](std::uint64_t value) {
+                seed ^= std::hash<std::uint64_t>{}(value) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+            };
+            for (const auto& axis : { key.constraint.horizontal, key.constraint.vertical })
+            {
+                combine(std::uint64_t { std::bit_cast<std::uint32_t>(axis.low) } << 32 | std::bit_cast<std::uint32_t>(axis.high));
+                combine(axis.strictness);
+            }
+            return seed;
+        }
+    };
+
+    struct Entry
+    {
+        std::string_view script; // into texts_
+        float left, right, top, bottom;
+
+        Stage stage() const { return { left, right, top, bottom }; }
+    };
+
+    const TMeasure                                      measure_;
+    const size_t                                        capacity_;
+    mutable std::unordered_map<Key, Entry, KeyHash>     entries_ {};
+    mutable ScriptTable                                 texts_ {};
+    mutable size_t                                      hits_ {0};
+    mutable size_t                                      misses_ {0};
+};
+
+} // namespace val
@@ -0,0 +1,125 @@
+//
+//  output.hpp
+//  playground
+//
+//  Triple-buffered screens flushed by a dedicated output thread.
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+#include "typedefs.hpp"
+#include "instrument.hpp"
+
+namespace val
+{
+
+/*
+ * Decouples painting from writing out. The layout thread paints into the back
+ * screen and submits it; the output thread flushes the most recently submitted
+ * screen while the next one is laid out and painted, so a slow terminal only
+ * slows down output, never layout.
+ *
+ * Three screens rotate through a single atomic slot: the producer swaps its
+ * finished back screen into the slot, the output thread swaps its presented
+ * front screen out for it. Neither side ever takes a lock or waits for the
+ * other. When output falls behind, a newer submission simply replaces the one
+ * in the slot, and that frame is dropped.
+ *
+ * acquire() hands out a screen that still holds an older frame; clear it (or
+ * repaint all of it) before painting. Destruction presents the last submitted
+ * frame, then joins the output thread.
+ */
+class AsyncOutput
+{
+public:
+    using present_fn = std::function<void(const Screen&)>;
+
+    AsyncOutput(size_t width, size_t height, present_fn present)
+    : screens_ { make_screen(width, height), make_screen(width, height), make_screen(width, height) },
+      present_ { std::move(present) },
+      thread_ { [this](std::stop_token stop) { run(stop); } }
+    {}
+
+    ~AsyncOutput()
+    {
+        thread_.request_stop();
+        slot_.fetch_or(stopping, std::memory_order_release);
+        slot_.notify_one();
+    }
+
+    AsyncOutput(const AsyncOutput&) = delete;
+    AsyncOutput& operator=(const AsyncOutput&) = delete;
+
+    // The screen to paint the next frame into (layout thread only)
+    Screen& acquire() { return screens_[back_]; }
+
+    // Hands the painted back screen over to the output thread
+    void submit()
+    {
+        const auto previous = slot_.exchange(back_ | fresh, std::memory_order_acq_rel);
+        back_ = previous & index_mask;
+        if (previous & fresh)
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            THEATER_COUNT("frames_dropped", 1);
+        }
+        slot_.notify_one();
+    }
+
+    size_t frames_presented() const { return presented_.load(std::memory_order_relaxed); }
+    size_t frames_dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr std::uint32_t index_mask   = 0b0011;
+    static constexpr std::uint32_t fresh        = 0b0100;   // the slot holds a frame not yet presented
+    static constexpr std::uint32_t stopping     = 0b1000;
+
+    void run(std::stop_token stop)
+    {
+        while (true)
+        {
+            auto observed = slot_.load(std::memory_order_acquire);
+            while (!(observed & (fresh | stopping)) && !stop.stop_requested())
+            {
+                slot_.wait(observed, std::memory_order_acquire);
+                observed = slot_.load(std::memory_order_acquire);
+            }
+
+            if (observed & fresh)
+            {
+                // Take the fresh frame, leave the presented one behind. The
+                // stopping bit may be set at any moment: keep the one in the slot.
+                while (!slot_.compare_exchange_weak(observed, front_ | (observed & stopping),
+                                                    std::memory_order_acq_rel, std::memory_order_acquire)) {}
+                front_ = observed & index_mask;
+                {
+                    THEATER_SCOPE(output, "async_output");
+                    present_(screens_[front_]);
+                }
+                presented_.fetch_add(1, std::memory_order_relaxed);
+            }
+            else if (stop.stop_requested()) return;
+        }
+    }
+
+    std::array<Screen, 3>       screens_;
+    const present_fn            present_;
+
+    std::uint32_t               back_ {0};              // owned by the layout thread
+    std::uint32_t               front_ {1};             // owned by the output thread
+    std::atomic<std::uint32_t>  slot_ {2};
+
+    std::atomic<size_t>         presented_ {0};
+    std::atomic<size_t>         dropped_ {0};
+
+    // Last, so the screens and slot exist before the thread starts and outlive its join
+    std::jthread                thread_;
+};
+
+} // namespace val
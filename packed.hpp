@@ -0,0 +1,146 @@
+//
+//  packed.hpp
+//  playground
+//
+//  Compact, variant-free representation of directions.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+
+#include "typedefs.hpp"
+
+namespace val
+{
+
+/*
+ * A Direction as a plain value plus a strictness flag. Resolving it needs no
+ * std::visit, so the rules below compile to compares and selects.
+ *
+ * The resolvers mirror the `overloaded` rules of resolve_axis and
+ * resolve_direction exactly, including std::min's choice of operand,
+ * so results are bit-for-bit identical (signed zeros and NaNs included).
+ */
+struct PackedDirection
+{
+    float value;
+    bool  strict;
+};
+
+// Both bounds of an axis, with strictness packed into two bits
+struct PackedAxis
+{
+    static constexpr std::uint8_t strict_low  = 1 << 0;
+    static constexpr std::uint8_t strict_high = 1 << 1;
+
+    float           low;
+    float           high;
+    std::uint8_t    strictness;
+
+    constexpr bool low_strict() const { return strictness & strict_low; }
+    constexpr bool high_strict() const { return strictness & strict_high; }
+};
+
+struct PackedInstruction
+{
+    PackedAxis horizontal;
+    PackedAxis vertical;
+};
+
+constexpr PackedDirection pack(const Direction& direction)
+{
+    return { extract(direction), std::holds_alternative<def>(direction) };
+}
+
+constexpr PackedAxis pack(const AxisDirection& axis)
+{
+    const auto low  = pack(axis.low);
+    const auto high = pack(axis.high);
+    return {
+        low.value,
+        high.value,
+        static_cast<std::uint8_t>((low.strict ? PackedAxis::strict_low : 0) | (high.strict ? PackedAxis::strict_high : 0))
+    };
+}
+
+constexpr PackedInstruction pack(const Instruction& instruction)
+{
+    return { pack(instruction.horizontal), pack(instruction.vertical) };
+}
+
+// Same operand order as std::min(upper, incoming)
+constexpr float min_towards(const float upper, const float incoming)
+{
+    return incoming < upper ? incoming : upper;
+}
+
+constexpr float resolve_direction_packed(const PackedDirection& direction, const float incoming_value)
+{
+    return direction.strict ? direction.value : min_towards(direction.value, incoming_value);
+}
+
+/*
+ * [def, def]: below low -> low, otherwise high
+ * [def, lnt]: below low -> low, otherwise min(high, incoming)
+ * [lnt, lnt]: below low -> low, otherwise min(high, incoming)
+ * [lnt, def]: high
+ */
+constexpr float resolve_axis_packed(const float low, const float high, const std::uint8_t strictness, const float incoming_value)
+{
+    const bool low_strict  = strictness & PackedAxis::strict_low;
+    const bool high_strict = strictness & PackedAxis::strict_high;
+    const float upper      = high_strict ? high : min_towards(high, incoming_value);
+    const bool clamp_low   = (incoming_value < low) & (low_strict | !high_strict);
+    return clamp_low ? low : upper;
+}
+
+constexpr float resolve_axis_packed(const PackedAxis& axis, const float incoming_value)
+{
+    return resolve_axis_packed(axis.low, axis.high, axis.strictness, incoming_value);
+}
+
+/*
+ * Structure-of-arrays view over a batch of axis instructions. Keeping the
+ * fields in separate arrays lets the batched resolver below auto-vectorize.
+ */
+struct AxisColumns
+{
+    std::span<const float>          low;
+    std::span<const float>          high;
+    std::span<const std::uint8_t>   strictness;
+
+    size_t size() const { return low.size(); }
+};
+
+// Resolves axis[i] against incoming[i] into out[i] for every instruction
+inline void resolve_axis_batch(const AxisColumns& axes, std::span<const float> incoming, std::span<float> out)
+{
+    const size_t count = axes.size();
+    if (axes.high.size() != count || axes.strictness.size() != count || incoming.size() != count || out.size() < count)
+        throw std::invalid_argument("resolve_axis_batch: mismatched batch sizes");
+
+    const float* __restrict low         = axes.low.data();
+    const float* __restrict high        = axes.high.data();
+    const std::uint8_t* __restrict flag = axes.strictness.data();
+    const float* __restrict in          = incoming.data();
+    float* __restrict result            = out.data();
+
+    for (size_t idx { 0 }; idx < count; ++idx)
+        result[idx] = resolve_axis_packed(low[idx], high[idx], flag[idx], in[idx]);
+}
+
+// Array-of-structures convenience overload
+inline void resolve_axis_batch(std::span<const PackedAxis> axes, std::span<const float> incoming, std::span<float> out)
+{
+    const size_t count = axes.size();
+    if (incoming.size() != count || out.size() < count)
+        throw std::invalid_argument("resolve_axis_batch: mismatched batch sizes");
+
+    for (size_t idx { 0 }; idx < count; ++idx)
+        out[idx] = resolve_axis_packed(axes[idx], incoming[idx]);
+}
+
+} // namespace val
@@ -0,0 +1,177 @@
+//
+//  pool.hpp
+//  playground
+//
+//  A small work-stealing thread pool.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace val
+{
+
+/*
+ * Every worker owns a queue. Work submitted from a worker goes to its own
+ * queue and is taken back LIFO (it is likely still hot in cache); idle workers
+ * steal FIFO from the other queues. A thread waiting in parallel_for runs
+ * tasks too, so nested parallel_for calls cannot deadlock the pool.
+ *
+ * A pool of zero threads runs everything on the calling thread.
+ */
+class ThreadPool
+{
+public:
+    explicit ThreadPool(size_t threads = std::max(1u, std::thread::hardware_concurrency()))
+    {
+        queues_.reserve(threads + 1);
+        for (size_t idx { 0 }; idx < threads + 1; ++idx) queues_.push_back(std::make_unique<Queue>());
+        workers_.reserve(threads);
+        for (size_t idx { 0 }; idx < threads; ++idx)
+            workers_.emplace_back([this, idx](std::stop_token stop) { work(idx + 1, stop); });
+    }
+
+    ~ThreadPool()
+    {
+        for (auto& worker : workers_) worker.request_stop();
+        {
+            std::lock_guard lock { sleep_mutex_ };
+        }
+        wake_.notify_all();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers_.size(); }
+
+    /*
+     * Calls fn(idx) for every idx in [0, count), in chunks of `grain`, and
+     * returns once all calls finished. The first exception thrown by fn is
+     * rethrown here.
+     */
+    template<class F>
+    void parallel_for(size_t count, F&& fn, size_t grain = 1)
+    {
+        if (count == 0) return;
+        grain = std::max<size_t>(grain, 1);
+
+        if (workers_.empty() || count <= grain)
+        {
+            for (size_t idx { 0 }; idx < count; ++idx) fn(idx);
+            return;
+        }
+
+        struct Batch
+        {
+            std::atomic<size_t>     remaining;
+            std::mutex              error_mutex {};
+            std::exception_ptr      error {};
+        };
+        Batch batch { (count + grain - 1) / grain };
+
+        for (size_t begin { 0 }; begin < count; begin += grain)
+        {
+            const size_t end = std::min(begin + grain, count);
+            push([&batch, &fn, begin, end] {
+                try {
+                    for (size_t idx { begin }; idx < end; ++idx) fn(idx);
+                } catch (...) {
+                    std::lock_guard lock { batch.error_mutex };
+                    if (!batch.error) batch.error = std::current_exception();
+                }
+                batch.remaining.fetch_sub(1, std::memory_order_acq_rel);
+            });
+        }
+
+        while (batch.remaining.load(std::memory_order_acquire) > 0)
+            if (!run_one(home())) std::this_thread::yield();
+
+        if (batch.error) std::rethrow_exception(batch.error);
+    }
+
+private:
+    using Task = std::function<void()>;
+
+    struct Queue
+    {
+        std::mutex          mutex {};
+        std::deque<Task>    tasks {};
+    };
+
+    // Queue of the calling thread: its own for workers, the shared one (0) otherwise
+    size_t home() const { return current_owner() == this ? current_index() : 0; }
+
+    static const ThreadPool*& current_owner() { thread_local const ThreadPool* owner { nullptr }; return owner; }
+    static size_t& current_index() { thread_local size_t index { 0 }; return index; }
+
+    void push(Task task)
+    {
+        auto& queue = *queues_[home()];
+        {
+            std::lock_guard lock { queue.mutex };
+            queue.tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard lock { sleep_mutex_ };
+            ++queued_;
+        }
+        wake_.notify_one();
+    }
+
+    // Pops from the own queue's back, or steals from the front of another one
+    bool run_one(size_t own)
+    {
+        Task task {};
+        for (size_t offset { 0 }; offset < queues_.size() && !task; ++offset)
+        {
+            auto& queue = *queues_[(own + offset) % queues_.size()];
+            std::lock_guard lock { queue.mutex };
+            if (queue.tasks.empty()) continue;
+            if (offset == 0) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            } else {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+        }
+        if (!task) return false;
+        {
+            std::lock_guard lock { sleep_mutex_ };
+            --queued_;
+        }
+        task();
+        return true;
+    }
+
+    void work(size_t index, std::stop_token stop)
+    {
+        current_owner() = this;
+        current_index() = index;
+        while (!stop.stop_requested())
+        {
+            if (run_one(index)) continue;
+            std::unique_lock lock { sleep_mutex_ };
+            wake_.wait(lock, [&] { return queued_ > 0 || stop.stop_requested(); });
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>>     queues_ {};
+    std::mutex                              sleep_mutex_ {};
+    std::condition_variable                 wake_ {};
+    size_t                                  queued_ {0};
+    std::vector<std::jthread>               workers_ {};
+};
+
+} // namespace val
@@ -0,0 +1,199 @@
+//
+//  present.hpp
+//  playground
+//
+//  Damage-tracked output of screens to an ANSI terminal.
+//
+
+#pragma once
+
+#include <charconv>
+#include <ostream>
+#include <string>
+#include <type_traits>
+
+#include "typedefs.hpp"
+#include "cell.hpp"
+
+namespace val
+{
+
+/*
+ * Presents successive frames to a terminal. The previously presented frame is
+ * kept, each row is compared against it and only the changed spans are written,
+ * each preceded by a cursor move. A whole frame is assembled into one string
+ * and written with a single call.
+ *
+ * When more than `full_repaint_ratio` of the cells changed (or the size of the
+ * screen did), the frame is repainted completely instead: past that point the
+ * cursor moves cost more than they save.
+ *
+ * Screens of packed cells (cell.hpp) are written with their attributes: the
+ * presenter tracks the attributes the terminal is left in and writes an SGR
+ * sequence only where the next written cell differs from them, across spans
+ * and frames alike. Glyphs are written as UTF-8.
+ */
+template<class TCell>
+class BasicTerminalPresenter
+{
+public:
+    struct Stats
+    {
+        size_t bytes_written    {0};
+        size_t cells_changed    {0};
+        size_t spans_written    {0};
+        size_t sgr_written      {0};
+        bool   full_repaint     {false};
+    };
+
+    explicit BasicTerminalPresenter(std::ostream& out, double full_repaint_ratio = 0.5)
+    : out_ { out }, full_repaint_ratio_ { full_repaint_ratio }
+    {}
+
+    // Writes the difference between `screen` and the previously presented frame
+    const Stats& present(const BasicScreen<TCell>& screen)
+    {
+        const auto& next = screen.buffer;
+        frame_.clear();
+        stats_ = {};
+
+        const bool same_size = has_previous_ && previous_.width == next.width && previous_.height == next.height;
+        if (same_size) stats_.cells_changed = count_changes(next);
+
+        const double total_cells = static_cast<double>(next.width * next.height);
+        stats_.full_repaint = !same_size || static_cast<double>(stats_.cells_changed) > full_repaint_ratio_ * total_cells;
+
+        if (stats_.full_repaint) write_full(next);
+        else write_damage(next);
+
+        if (!frame_.empty()) out_.write(frame_.data(), static_cast<std::streamsize>(frame_.size()));
+        out_.flush();
+        stats_.bytes_written = frame_.size();
+
+        remember(next);
+        return stats_;
+    }
+
+    // Forces the next frame to be repainted completely, attributes included
+    void invalidate()
+    {
+        has_previous_ = false;
+        attributes_known_ = false;
+    }
+
+    const Stats& last() const { return stats_; }
+
+private:
+    // Unchanged runs shorter than this are rewritten rather than skipped with a cursor move
+    static constexpr size_t merge_gap = 8;
+
+    size_t count_changes(const BasicFramebuffer<TCell>& next) const
+    {
+        size_t changed { 0 };
+        for (size_t y { 0 }; y < next.height; ++y)
+        {
+            const auto before = previous_.row(y);
+            const auto after  = next.row(y);
+            for (size_t x { 0 }; x < next.width; ++x) changed += before[x] != after[x];
+        }
+        return changed;
+    }
+
+    void move_to(size_t row, size_t col)
+    {
+        char digits[24];
+        frame_ += "\x1b[";
+        frame_.append(digits, std::to_chars(digits, digits + sizeof digits, row + 1).ptr);
+        frame_ += ';';
+        frame_.append(digits, std::to_chars(digits, digits + sizeof digits, col + 1).ptr);
+        frame_ += 'H';
+    }
+
+    void write_cells(const TCell* cells, size_t count)
+    {
+        if constexpr (std::is_same_v<TCell, char>)
+        {
+            frame_.append(cells, count);
+        }
+        else
+        {
+            for (size_t idx { 0 }; idx < count; ++idx)
+            {
+                const auto attributes = cells[idx].attributes();
+                if (!attributes_known_ || attributes != attributes_)
+                {
+                    append_sgr(frame_, attributes);
+                    attributes_ = attributes;
+                    attributes_known_ = true;
+                    ++stats_.sgr_written;
+                }
+                append_utf8(frame_, cells[idx].glyph());
+            }
+        }
+    }
+
+    void write_full(const BasicFramebuffer<TCell>& next)
+    {
+        if (!has_previous_ || previous_.width != next.width || previous_.height != next.height) frame_ += "\x1b[2J";
+        for (size_t y { 0 }; y < next.height; ++y)
+        {
+            const auto row = next.row(y);
+            move_to(y, 0);
+            write_cells(row.data(), row.size());
+            ++stats_.spans_written;
+        }
+    }
+
+    void write_damage(const BasicFramebuffer<TCell>& next)
+    {
+        for (size_t y { 0 }; y < next.height; ++y)
+        {
+            const auto before = previous_.row(y);
+            const auto after  = next.row(y);
+
+            size_t x { 0 };
+            while (x < next.width)
+            {
+                while (x < next.width && before[x] == after[x]) ++x;
+                if (x == next.width) break;
+
+                // Extend the span over changes separated by short unchanged runs
+                const size_t start = x;
+                size_t end = x + 1;
+                for (size_t probe { end }; probe < next.width && probe - end < merge_gap; ++probe)
+                    if (before[probe] != after[probe]) end = probe + 1;
+
+                move_to(y, start);
+                write_cells(after.data() + start, end - start);
+                ++stats_.spans_written;
+                x = end;
+            }
+        }
+    }
+
+    void remember(const BasicFramebuffer<TCell>& next)
+    {
+        if (!has_previous_ || previous_.width != next.width || previous_.height != next.height)
+            previous_ = make_framebuffer<TCell>(next.width, next.height);
+        for (size_t y { 0 }; y < next.height; ++y)
+        {
+            const auto row = next.row(y);
+            std::copy(row.begin(), row.end(), previous_.row(y).begin());
+        }
+        has_previous_ = true;
+    }
+
+    std::ostream&           out_;
+    const double            full_repaint_ratio_;
+
+    BasicFramebuffer<TCell> previous_ {};
+    bool                    has_previous_ {false};
+    Attributes              attributes_ {};         // what the terminal was left in
+    bool                    attributes_known_ {false};
+    std::string             frame_ {};
+    Stats                   stats_ {};
+};
+
+using TerminalPresenter = BasicTerminalPresenter<char>;
+
+} // namespace val
@@ -0,0 +1,114 @@
+//
+//  producers.hpp
+//  playground
+//
+//  Created by Emil Ahlbäck on 16.07.20.
+//  Copyright © 2020 Emil Ahlbäck. All rights reserved.
+//
+
+#pragma once
+
+#include <iostream>
+
+#include "typedefs.hpp"
+#include "display_list.hpp"
+#include "instrument.hpp"
+
+using TPerformanceBuffer = std::vector<val::preproduction>;
+
+
+// Generic over the crew, so a statically typed crew (val::BasicDirector of
+// plain lambdas) is called directly, while a val::Crew goes through std::function.
+// Advances the rehearsal's layout in place: no part of the crew is copied.
+// `director` stands in for the crew's own one, e.g. the crew's director bound to the stage.
+constexpr auto direct_scene =
+[]<class TCrew, class TDirector>(val::BasicRehearsal<TCrew>& rehearsal, const TDirector& director, std::string_view script) -> val::preproduction
+{
+    const val::Instruction instruction = [&] {
+        THEATER_SCOPE(instruct, director.name);
+        return director.instruct(rehearsal.stage, rehearsal.stage_layout);
+    }();
+    val::preproduction result = [&] {
+        THEATER_SCOPE(perform, director.name);
+        return rehearsal.crew.actor.perfom(instruction, script);
+    }();
+    {
+        THEATER_SCOPE(adjust, director.name);
+        rehearsal.stage_layout = director.adjust(rehearsal.stage, result.first, rehearsal.stage_layout);
+    }
+    return result;
+};
+
+constexpr auto play_scene = []<class TCrew>(val::BasicRehearsal<TCrew>& rehearsal, std::string_view script) -> val::preproduction
+{
+    return direct_scene(rehearsal, rehearsal.crew.director, script);
+};
+
+// The value form: a Set in, the next Set out
+constexpr auto act_scene = []<class TCrew>(const val::BasicSet<TCrew>& set, std::string_view script) -> std::pair<val::BasicSet<TCrew>, val::preproduction>
+{
+    val::BasicRehearsal<TCrew> rehearsal { set };
+    auto result = play_scene(rehearsal, script);
+    return {
+        val::BasicSet<TCrew> { set.stage, rehearsal.stage_layout, set.crew },
+        std::move(result)
+    };
+};
+
+const auto produce_scene =
+[]<class TCrew>(const val::BasicSet<TCrew>& set, std::string_view script) -> std::pair<val::BasicSet<TCrew>, val::preproduction>
+{
+    return act_scene(set, script);
+};
+
+// Only the running StageLayout is carried forward; the stage and crew never change,
+// so the director is bound to the stage once for the whole sequence. `scripts` is
+// any range of text (std::string, std::string_view...) that outlives `into`.
+const auto produce_scenes =
+[]<class TCrew, class TScripts>(const val::BasicSet<TCrew>& initial_set, TPerformanceBuffer& into, const TScripts& scripts)
+{
+    THEATER_SCOPE(layout, initial_set.crew.director.name);
+    val::BasicRehearsal<TCrew> rehearsal { initial_set };
+    val::bind_director(initial_set.crew.director, initial_set.stage, [&](const auto& director) {
+        for (const auto& script : scripts) into.push_back(direct_scene(rehearsal, director, script));
+    });
+};
+
+// Writes a painted screen with a ruler on top and borders around it
+void print_screen(const val::Screen& screen)
+{
+    THEATER_SCOPE(output, "print_buffer");
+    std::cout << std::string(screen.width + 2, '-');
+    std::cout << "\n|";
+    for (size_t idx { 0 }; idx < screen.width; ++idx) if (idx % 2 == 0) std::cout << idx % 10; else std::cout << ' ';
+    std::cout << "|\n|" << std::string(screen.width, '-') << "|\n";
+    
+    // One write per row: the row span is copied between the side borders
+    std::string line(screen.width + 3, '|');
+    line.back() = '\n';
+    for (size_t row_idx { 0 }; row_idx < screen.height; ++row_idx)
+    {
+        const auto row = screen.buffer.row(row_idx);
+        std::copy(row.begin(), row.end(), line.begin() + 1);
+        std::cout.write(line.data(), static_cast<std::streamsize>(line.size()));
+    }
+    std::cout << '|' << std::string(screen.width, '-') << "|\n";
+}
+
+void print_buffer(const TPerformanceBuffer& buffer, val::Screen screen)
+{
+    {
+        THEATER_SCOPE(paint, "print_buffer");
+        for (const auto& perf : buffer) if (val::raster::visible(perf.first, screen.buffer)) perf.second(screen);
+    }
+    print_screen(screen);
+}
+
+void print_buffer(const val::DisplayList& list, val::Screen screen)
+{
+    {
+        THEATER_SCOPE(paint, "print_buffer");
+        val::rasterize(list, screen);
+    }
+    print_screen(screen);
+}
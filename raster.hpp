@@ -0,0 +1,159 @@
+//
+//  raster.hpp
+//  playground
+//
+//  Run-based rasterization kernels over framebuffer rows.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+#include "typedefs.hpp"
+
+namespace val::raster
+{
+
+/*
+ * Every kernel works on whole runs of a row at once, so fills become memset
+ * and text becomes memcpy (both vectorized by the C library), instead of
+ * copying a temporary string one cell at a time.
+ *
+ * The kernels work on framebuffers of any cell type; on chars they reduce to
+ * exactly those C library calls, on packed cells to std::fill_n loops.
+ *
+ * Coordinates are signed cell indices and ranges are half-open: [begin, end).
+ * Clipping against the framebuffer happens here and only here: anything
+ * outside of it, including negative coordinates, is skipped, so actors can
+ * paint their full frame whether it is on screen, partly visible or not.
+ */
+using coordinate = std::ptrdiff_t;
+
+// Whether a painted frame [left, right) x [top, bottom] has any cell on screen; empty, inverted or NaN frames have none
+template<class TCell>
+constexpr bool visible(const Stage& frame, const BasicFramebuffer<TCell>& buffer)
+{
+    return frame.left < frame.right && frame.top <= frame.bottom
+        && frame.right > 0 && frame.left < static_cast<float>(buffer.width)
+        && frame.bottom >= 0 && frame.top < static_cast<float>(buffer.height);
+}
+
+// A frame bound as a cell index, clamped far beyond any framebuffer so that the conversion is always defined
+template<class T>
+constexpr coordinate cell_of(T value)
+{
+    if constexpr (std::is_floating_point_v<T>)
+    {
+        constexpr T limit = static_cast<T>(1 << 30);
+        return static_cast<coordinate>(std::clamp(value, -limit, limit));
+    }
+    else return static_cast<coordinate>(value);
+}
+
+// Sets cells [begin, end) of row y to `c`
+template<class TCell>
+void fill_run(BasicFramebuffer<TCell>& buffer, coordinate y, coordinate begin, coordinate end, std::type_identity_t<TCell> c)
+{
+    if (y < 0 || y >= static_cast<coordinate>(buffer.height)) return;
+    begin = std::max<coordinate>(begin, 0);
+    end = std::min(end, static_cast<coordinate>(buffer.width));
+    if (begin >= end) return;
+    auto* const run = buffer.row(static_cast<size_t>(y)).data() + begin;
+    if constexpr (std::is_same_v<TCell, char>) std::memset(run, c, static_cast<size_t>(end - begin));
+    else std::fill_n(run, end - begin, c);
+}
+
+// Sets the single cell (x, y) to `c`
+template<class TCell>
+void put(BasicFramebuffer<TCell>& buffer, coordinate y, coordinate x, std::type_identity_t<TCell> c)
+{
+    fill_run(buffer, y, x, x + 1, c);
+}
+
+// Copies `text` into row y, starting at cell `at`; packed cells take the attributes of `style`
+template<class TCell>
+void blit_text(BasicFramebuffer<TCell>& buffer, coordinate y, coordinate at, std::string_view text,
+               std::type_identity_t<TCell> style = TCell(' '))
+{
+    if (y < 0 || y >= static_cast<coordinate>(buffer.height)) return;
+    if (at < 0)
+    {
+        const auto skipped = std::min(static_cast<size_t>(-at), text.size());
+        text.remove_prefix(skipped);
+        at = 0;
+    }
+    if (at >= static_cast<coordinate>(buffer.width)) return;
+    const size_t length = std::min(text.size(), buffer.width - static_cast<size_t>(at));
+    auto* const run = buffer.row(static_cast<size_t>(y)).data() + at;
+    if constexpr (std::is_same_v<TCell, char>)
+    {
+        static_cast<void>(style);
+        if (length > 0) std::memcpy(run, text.data(), length);
+    }
+    else
+    {
+        for (size_t idx { 0 }; idx < length; ++idx) run[idx] = style.with_glyph(text[idx]);
+    }
+}
+
+// A row of the box interior: vertical borders on both ends around `fill`
+template<class TCell>
+void framed_run(BasicFramebuffer<TCell>& buffer, coordinate y, coordinate left, coordinate right,
+                std::type_identity_t<TCell> vertical, std::type_identity_t<TCell> fill)
+{
+    if (left >= right) return;
+    fill_run(buffer, y, left, right, fill);
+    put(buffer, y, left, vertical);
+    put(buffer, y, right - 1, vertical);
+}
+
+// Sets every cell of the rectangle [left, right) x [top, bottom) to `c`
+template<class TCell>
+void fill_rect(BasicFramebuffer<TCell>& buffer, coordinate left, coordinate right, coordinate top, coordinate bottom,
+               std::type_identity_t<TCell> c)
+{
+    top = std::max<coordinate>(top, 0);
+    bottom = std::min(bottom, static_cast<coordinate>(buffer.height));
+    for (coordinate y { top }; y < bottom; ++y) fill_run(buffer, y, left, right, c);
+}
+
+template<class TCell>
+struct BasicBoxStyle
+{
+    TCell corner;
+    TCell horizontal;
+    TCell vertical;
+    TCell fill;
+};
+
+using BoxStyle = BasicBoxStyle<char>;
+
+/*
+ * A framed box covering [left, right) x [top, bottom): the first and last rows
+ * are horizontal borders ending in corners, the rows between are a vertical
+ * border on each side around `fill`.
+ */
+template<class TCell>
+void frame_box(BasicFramebuffer<TCell>& buffer, coordinate left, coordinate right, coordinate top, coordinate bottom,
+               const BasicBoxStyle<TCell>& style)
+{
+    if (left >= right || top >= bottom) return;
+
+    const auto border = [&](coordinate y) {
+        fill_run(buffer, y, left, right, style.horizontal);
+        put(buffer, y, left, style.corner);
+        put(buffer, y, right - 1, style.corner);
+    };
+
+    border(top);
+    const coordinate first = std::max<coordinate>(top + 1, 0);
+    const coordinate last  = std::min(bottom - 1, static_cast<coordinate>(buffer.height));
+    for (coordinate y { first }; y < last; ++y) framed_run(buffer, y, left, right, style.vertical, style.fill);
+    if (bottom - top > 1) border(bottom - 1);
+}
+
+} // namespace val::raster
@@ -0,0 +1,98 @@
+//
+//  replay.cpp
+//  playground
+//
+//  Replays captured display list snapshots through print_buffer.
+//
+//  ./replay <snapshot>...          time painting each snapshot
+//  ./replay --show <snapshot>      print one snapshot to the terminal
+//  ./replay --sample <file> [n]    capture a sample frame of n buttons
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "typedefs.hpp"
+#include "directors.hpp"
+#include "actors.hpp"
+#include "producers.hpp"
+#include "display_list.hpp"
+#include "snapshot.hpp"
+#include "bench.hpp"
+
+namespace replay
+{
+void sample(const std::string& path, size_t count)
+{
+    std::vector<std::string> scripts {};
+    scripts.reserve(count);
+    for (size_t idx { 0 }; idx < count; ++idx) scripts.push_back("Button " + std::to_string(idx));
+
+    constexpr size_t width = 120;
+    const size_t height = count * 3;
+    const val::Stage stage { 0, static_cast<float>(width), 0, static_cast<float>(height) };
+    val::DisplayList list {};
+    produce_display_list(stage, {}, dir::stack::statically::vertically, measure_button, scripts, list);
+
+    std::ofstream out { path, std::ios::binary };
+    val::write_snapshot(out, list, width, height);
+}
+
+void show(const std::string& path)
+{
+    const val::MappedSnapshot snapshot { path };
+    val::DisplayList list {};
+    val::load_snapshot(snapshot.view(), list);
+    print_buffer(list, val::make_screen(snapshot.view().width, snapshot.view().height));
+}
+
+// Paints every snapshot into a null sink, like the print_buffer benchmarks
+void time(const std::vector<std::string>& paths)
+{
+    bench::NullSink sink {};
+    bench::print_header();
+    for (const auto& path : paths)
+    {
+        const val::MappedSnapshot snapshot { path };
+        const auto& view = snapshot.view();
+        val::DisplayList list {};
+        val::load_snapshot(view, list);
+        const auto screen = val::make_screen(view.width, view.height);
+
+        const bench::Redirect console { std::cout, &sink };
+        bench::run(path + " print_buffer", list.size(), bench::repetitions_for(view.width * view.height),
+                   [&] { print_buffer(list, screen); }, &sink);
+    }
+}
+} // namespace replay
+
+int main(int argc, char** argv)
+{
+    const std::vector<std::string> args(argv + 1, argv + argc);
+    try
+    {
+        if (args.size() >= 2 && args[0] == "--sample")
+            replay::sample(args[1], args.size() > 2 ? std::strtoull(args[2].c_str(), nullptr, 10) : 1'000);
+        else if (args.size() == 2 && args[0] == "--show")
+            replay::show(args[1]);
+        else if (!args.empty() && !args[0].starts_with("--"))
+            replay::time(args);
+        else
+        {
+            std::fprintf(stderr, "usage: replay <snapshot>... | --show <snapshot> | --sample <file> [buttons]\n");
+            return 2;
+        }
+    }
+    catch (const std::exception& error)
+    {
+        std::fprintf(stderr, "replay: %s\n", error.what());
+        return 1;
+    }
+    return 0;
+}
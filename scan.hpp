@@ -0,0 +1,153 @@
+//
+//  scan.hpp
+//  playground
+//
+//  Parallel layout of stacking directors as measure + prefix scan.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <numeric>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "typedefs.hpp"
+#include "directors.hpp"
+#include "batch.hpp"
+#include "pool.hpp"
+
+namespace val
+{
+
+enum class StackAxis
+{
+    horizontal,     // dir::stack::horizontally
+    vertical        // dir::stack::vertically
+};
+
+namespace detail
+{
+// Largest magnitude below which float sums of integers are exact, in any order
+constexpr float exact_integer_limit = 16777216.0f; // 2^24
+
+// Whether every partial sum of `steps` (starting at `start`) is exact in any association
+inline bool scan_is_exact(float start, std::span<const float> steps)
+{
+    double magnitude = std::fabs(start);
+    if (std::trunc(start) != start) return false;
+    for (const auto step : steps)
+    {
+        if (!std::isfinite(step) || std::trunc(step) != step) return false;
+        magnitude += std::fabs(step);
+    }
+    return magnitude <= exact_integer_limit;
+}
+
+// offsets[i] = start + steps[0] + ... + steps[i - 1]
+inline void exclusive_scan(float start, std::span<const float> steps, std::span<float> offsets, ThreadPool& pool)
+{
+    const size_t count = steps.size();
+    if (!scan_is_exact(start, steps))
+    {
+        // Float addition does not reassociate; keep the order of the sequential producer
+        float offset = start;
+        for (size_t idx { 0 }; idx < count; ++idx) { offsets[idx] = offset; offset += steps[idx]; }
+        return;
+    }
+
+    const size_t chunks = std::min(count, (pool.size() + 1) * 4);
+    const size_t chunk  = (count + chunks - 1) / chunks;
+    std::vector<float> totals(chunks, 0.0f);
+
+    pool.parallel_for(chunks, [&](size_t c) {
+        const size_t begin = c * chunk, end = std::min(count, begin + chunk);
+        totals[c] = std::accumulate(steps.begin() + begin, steps.begin() + end, 0.0f);
+    });
+    std::exclusive_scan(totals.begin(), totals.end(), totals.begin(), start);
+    pool.parallel_for(chunks, [&](size_t c) {
+        const size_t begin = c * chunk, end = std::min(count, begin + chunk);
+        float offset = totals[c];
+        for (size_t idx { begin }; idx < end; ++idx) { offsets[idx] = offset; offset += steps[idx]; }
+    });
+}
+} // namespace detail
+
+/*
+ * Lays out `scripts` like produce_scenes with dir::stack::horizontally or
+ * dir::stack::vertically, spreading the measuring over the pool:
+ *
+ *  1. every actor is measured in parallel at the stack's start, giving its extent
+ *  2. offsets are the exclusive prefix sum of extent + 1 + margin
+ *  3. every actor is placed in parallel at its offset, and its extent checked
+ *  4. the layout is folded sequentially (cheap adds) up to the first actor whose
+ *     extent changed with its position (e.g. clamped by the stage end), and
+ *     the rest is laid out sequentially from there
+ *
+ * The scan itself only runs in parallel when every partial sum is exact (whole
+ * cells, below 2^24), so placements and the returned layout are bit-for-bit
+ * those of the sequential producer.
+ */
+template<Measures TMeasure, Scripts TScripts>
+StageLayout scan_layout(StackAxis axis, const Stage& stage, const StageLayout& initial, const TMeasure& measure,
+                        const TScripts& scripts, ThreadPool& pool, SceneBatch& into)
+{
+    namespace kernel = dir::stack::kernel;
+
+    const bool horizontal = axis == StackAxis::horizontal;
+    const auto instruct = [&](const StageLayout& layout) {
+        return horizontal ? kernel::horizontal_next(stage, layout) : kernel::vertical_next(stage, layout);
+    };
+    const auto adjust = [&](const Stage& perf, const StageLayout& layout) {
+        return horizontal ? kernel::horizontal_adjust(stage, perf, layout) : kernel::vertical_adjust(stage, perf, layout);
+    };
+    const auto extent = [&](const Stage& perf) {
+        return horizontal ? perf.right - perf.left : perf.bottom - perf.top;
+    };
+    const auto at_offset = [&](float offset) {
+        auto layout = initial;
+        (horizontal ? layout.x_offset : layout.y_offset) = offset;
+        return layout;
+    };
+    const float start  = horizontal ? initial.x_offset : initial.y_offset;
+    const float margin = horizontal ? initial.horizontal_margin : initial.vertical_margin;
+
+    const size_t count = scripts.size();
+    const size_t grain = std::max<size_t>(64, count / ((pool.size() + 1) * 8));
+
+    std::vector<float> extents(count), steps(count), offsets(count);
+    pool.parallel_for(count, [&](size_t idx) {
+        extents[idx] = extent(measure(instruct(initial), scripts[idx]));
+        steps[idx] = (extents[idx] + 1) + margin; // as in the stacking adjust
+    }, grain);
+
+    detail::exclusive_scan(start, steps, offsets, pool);
+
+    const size_t base = into.size();
+    into.resize(base + count);
+    std::atomic<size_t> first_mismatch { count };
+    pool.parallel_for(count, [&](size_t idx) {
+        const auto placed = measure(instruct(at_offset(offsets[idx])), scripts[idx]);
+        into.assign(base + idx, placed, idx);
+        if (!(extent(placed) == extents[idx]))
+        {
+            auto seen = first_mismatch.load(std::memory_order_relaxed);
+            while (idx < seen && !first_mismatch.compare_exchange_weak(seen, idx, std::memory_order_relaxed)) {}
+        }
+    }, grain);
+
+    const size_t speculated = first_mismatch.load();
+    auto layout = initial;
+    for (size_t idx { 0 }; idx < speculated; ++idx) layout = adjust(into.stage(base + idx), layout);
+    for (size_t idx { speculated }; idx < count; ++idx)
+    {
+        const auto placed = measure(instruct(layout), scripts[idx]);
+        into.assign(base + idx, placed, idx);
+        layout = adjust(placed, layout);
+    }
+    return layout;
+}
+
+} // namespace val
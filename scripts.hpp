@@ -0,0 +1,95 @@
+//
+//  scripts.hpp
+//  playground
+//
+//  Interned script text with stable views.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace val
+{
+
+/*
+ * Owns script text for views to point into. Each distinct text is stored once,
+ * in large chunks that never move, so interning returns a view that stays
+ * valid (and equal texts share one view) until the table is cleared or
+ * destroyed. Handing those views to the producers means truncating, measuring
+ * and painting a script never copies its text.
+ *
+ * Not thread-safe: intern from one thread, read the views from any.
+ */
+class ScriptTable
+{
+public:
+    explicit ScriptTable(size_t chunk_bytes = 64 * 1024)
+    : chunk_bytes_ { std::max<size_t>(chunk_bytes, 1) }
+    {}
+
+    ScriptTable(const ScriptTable&) = delete;
+    ScriptTable& operator=(const ScriptTable&) = delete;
+
+    std::string_view intern(std::string_view text)
+    {
+        if (const auto found = views_.find(text); found != views_.end()) return *found;
+
+        const std::string_view stored { store(text), text.size() };
+        views_.insert(stored);
+        return stored;
+    }
+
+    // Interns every script, in order
+    template<class TScripts>
+    std::vector<std::string_view> intern_all(const TScripts& scripts)
+    {
+        std::vector<std::string_view> interned {};
+        interned.reserve(std::size(scripts));
+        for (const auto& script : scripts) interned.push_back(intern(script));
+        return interned;
+    }
+
+    size_t size() const { return views_.size(); }
+    size_t bytes() const { return bytes_; }
+
+    void clear()
+    {
+        views_.clear();
+        chunks_.clear();
+        used_ = capacity_ = bytes_ = 0;
+    }
+
+private:
+    const char* store(std::string_view text)
+    {
+        if (text.empty()) return "";
+        if (text.size() > capacity_ - used_)
+        {
+            // Texts larger than a chunk get a chunk of their own
+            capacity_ = std::max(chunk_bytes_, text.size());
+            chunks_.push_back(std::make_unique<char[]>(capacity_));
+            used_ = 0;
+        }
+        char* const at = chunks_.back().get() + used_;
+        std::memcpy(at, text.data(), text.size());
+        used_ += text.size();
+        bytes_ += text.size();
+        return at;
+    }
+
+    const size_t                            chunk_bytes_;
+    std::vector<std::unique_ptr<char[]>>    chunks_ {};
+    size_t                                  used_ {0};
+    size_t                                  capacity_ {0};
+    size_t                                  bytes_ {0};
+    std::unordered_set<std::string_view>    views_ {};
+};
+
+} // namespace val
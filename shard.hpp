@@ -0,0 +1,223 @@
+//
+//  shard.hpp
+//  playground
+//
+//  Layout of a wall of tiles, one instance per tile, sharing only a summary.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "typedefs.hpp"
+#include "directors.hpp"
+#include "batch.hpp"
+#include "window.hpp"
+
+namespace val
+{
+
+// A global stage cut into columns x rows tiles, e.g. one per display of a wall
+struct TileGrid
+{
+    const Stage     stage;
+    const size_t    columns;
+    const size_t    rows;
+
+    size_t size() const { return columns * rows; }
+
+    // Tile `idx`, counted row by row, covering [left, right) x [top, bottom) of the stage
+    Stage tile(size_t idx) const
+    {
+        const auto at = [](float low, float high, size_t part, size_t parts) {
+            return low + (high - low) * static_cast<float>(part) / static_cast<float>(parts);
+        };
+        const size_t column = idx % columns, row = idx / columns;
+        return { at(stage.left, stage.right, column, columns), at(stage.left, stage.right, column + 1, columns),
+                 at(stage.top, stage.bottom, row, rows), at(stage.top, stage.bottom, row + 1, rows) };
+    }
+};
+
+// `placed` in the coordinates of a screen showing `tile` alone
+constexpr Stage tile_local(const Stage& placed, const Stage& tile)
+{
+    return { placed.left - tile.left, placed.right - tile.left, placed.top - tile.top, placed.bottom - tile.top };
+}
+
+// The scripts [first, second) shard `shard` of `shards` measures for the summary
+constexpr std::pair<size_t, size_t> shard_range(size_t count, size_t shard, size_t shards)
+{
+    return { count * shard / shards, count * (shard + 1) / shards };
+}
+
+/*
+ * What every tile needs to know about a dir::stack::vertically list to place
+ * any of its rows: the extent of each row, run-length encoded (lists of equal
+ * buttons are a single run), and the StageLayout the stack starts from.
+ *
+ * Measuring is split across the instances: each measures its shard_range of
+ * the scripts, the partial summaries are exchanged in their wire form (write /
+ * parse; 48 bytes plus 8 per run) and appended in order, and every instance
+ * builds the same RowIndex from the result. Rows are measured like
+ * RowIndex::measured, and the offsets are accumulated in the order of
+ * vertical_adjust, so they match a full layout exactly.
+ */
+class StackSummary
+{
+public:
+    struct Run
+    {
+        std::uint32_t   count;
+        float           extent; // bottom - top of each placed row
+    };
+
+    explicit StackSummary(const StageLayout& layout) : layout_ { layout } {}
+
+    // Measures one shard of the scripts
+    template<Measures TMeasure, Scripts TScripts>
+    static StackSummary measured(const Stage& stage, const StageLayout& layout, const TMeasure& measure,
+                                 const TScripts& scripts)
+    {
+        StackSummary summary { layout };
+        const auto instruction = dir::stack::kernel::vertical_next(stage, layout);
+        for (const auto& script : scripts)
+        {
+            const auto placed = measure(instruction, script);
+            summary.push(placed.bottom - placed.top);
+        }
+        return summary;
+    }
+
+    void push(float extent, std::uint32_t count = 1)
+    {
+        if (count == 0) return;
+        if (!runs_.empty() && runs_.back().extent == extent && runs_.back().count <= max_run - count) runs_.back().count += count;
+        else runs_.push_back({ count, extent });
+        rows_ += count;
+    }
+
+    // Appends the summary of the shard that follows this one
+    void append(const StackSummary& next)
+    {
+        for (const auto& run : next.runs_) push(run.extent, run.count);
+    }
+
+    size_t rows() const { return rows_; }
+    std::span<const Run> runs() const { return runs_; }
+    const StageLayout& layout() const { return layout_; }
+
+    /*
+     * The index of every row. A single run needs no per-row offsets as long
+     * as start + idx * step is exact (whole cells, below 2^24).
+     */
+    RowIndex index() const
+    {
+        const float extent = runs_.empty() ? 0 : runs_.front().extent;
+        const float step   = (extent + 1) + layout_.vertical_margin;
+        const auto whole   = [](float value) { return std::isfinite(value) && std::trunc(value) == value; };
+        if (runs_.size() <= 1 && whole(layout_.y_offset) && whole(step)
+            && std::fabs(layout_.y_offset) + static_cast<double>(rows_) * std::fabs(step) <= 16777216.0)
+            return RowIndex::fixed(rows_, extent, layout_);
+
+        std::vector<float> extents {};
+        extents.reserve(rows_);
+        for (const auto& run : runs_) extents.insert(extents.end(), run.count, run.extent);
+        return RowIndex::cached(extents, layout_);
+    }
+
+    void write(std::ostream& out) const;
+    static StackSummary parse(std::span<const std::byte> bytes);
+
+private:
+    static constexpr std::uint32_t max_run = std::numeric_limits<std::uint32_t>::max();
+
+    StageLayout         layout_;
+    size_t              rows_ {0};
+    std::vector<Run>    runs_ {};
+};
+
+// The wire form, little endian: this header, then Run[run_count]
+struct StackSummaryHeader
+{
+    static constexpr std::uint32_t expected_magic   = 0x54534854; // "THST"
+    static constexpr std::uint32_t expected_version = 1;
+
+    std::uint32_t   magic;
+    std::uint32_t   version;
+    std::uint64_t   rows;
+    std::uint64_t   run_count;
+    StageLayout     layout;
+};
+
+static_assert(sizeof(StackSummaryHeader) == 48 && std::is_trivially_copyable_v<StackSummaryHeader>);
+static_assert(sizeof(StackSummary::Run) == 8 && std::is_trivially_copyable_v<StackSummary::Run>);
+static_assert(std::endian::native == std::endian::little, "stack summaries are little endian");
+
+inline void StackSummary::write(std::ostream& out) const
+{
+    const StackSummaryHeader header {
+        StackSummaryHeader::expected_magic, StackSummaryHeader::expected_version, rows_, runs_.size(), layout_
+    };
+    out.write(reinterpret_cast<const char*>(&header), sizeof header);
+    out.write(reinterpret_cast<const char*>(runs_.data()), static_cast<std::streamsize>(runs_.size() * sizeof(Run)));
+    if (!out) throw std::runtime_error("writing stack summary failed");
+}
+
+inline StackSummary StackSummary::parse(std::span<const std::byte> bytes)
+{
+    if (bytes.size() < sizeof(StackSummaryHeader)) throw std::runtime_error("stack summary truncated");
+
+    StackSummaryHeader header {};
+    std::memcpy(&header, bytes.data(), sizeof header);
+    if (header.magic != StackSummaryHeader::expected_magic) throw std::runtime_error("not a stack summary");
+    if (header.version != StackSummaryHeader::expected_version)
+        throw std::runtime_error("unsupported stack summary version " + std::to_string(header.version));
+    if (header.run_count != (bytes.size() - sizeof header) / sizeof(Run) || (bytes.size() - sizeof header) % sizeof(Run) != 0)
+        throw std::runtime_error("stack summary size does not match its header");
+
+    StackSummary summary { header.layout };
+    summary.runs_.resize(static_cast<size_t>(header.run_count));
+    std::memcpy(summary.runs_.data(), bytes.data() + sizeof header, summary.runs_.size() * sizeof(Run));
+    for (const auto& run : summary.runs_) summary.rows_ += run.count;
+    if (summary.rows_ != header.rows) throw std::runtime_error("stack summary rows do not match its runs");
+    return summary;
+}
+
+/*
+ * Lays out only the rows of a dir::stack::vertically list that intersect
+ * `tile`: the index leads straight to the rows crossing the tile (as in
+ * layout_window), and of those, stages beside the tile are dropped. Placed
+ * stages are appended to `into` in global coordinates, identical to the same
+ * stages of a full layout; paint them at tile_local positions.
+ */
+template<Measures TMeasure, Scripts TScripts>
+void layout_tile(const Stage& stage, const RowIndex& index, const TMeasure& measure,
+                 const TScripts& scripts, const Stage& tile, SceneBatch& into)
+{
+    const size_t base = into.size();
+    layout_window(stage, index, measure, scripts, { tile.top, tile.bottom }, 0, into);
+
+    size_t kept { base };
+    for (size_t idx { base }; idx < into.size(); ++idx)
+    {
+        const auto placed = into.stage(idx);
+        const bool inside = placed.right > tile.left && placed.left < tile.right
+                         && placed.bottom >= tile.top && placed.top < tile.bottom;
+        if (inside) into.assign(kept++, placed, into.script_index[idx]);
+    }
+    into.resize(kept);
+}
+
+} // namespace val
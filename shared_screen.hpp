@@ -0,0 +1,288 @@
+//
+//  shared_screen.hpp
+//  playground
+//
+//  Screens in shared memory, readable by other processes without copying.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "typedefs.hpp"
+
+namespace val
+{
+
+/*
+ * The start of a shared frame region. Two frame slots follow it; the producer
+ * paints into one while readers read the other, then publishes it.
+ *
+ * Every slot has its own sequence number, odd while the slot is being painted
+ * and even once it is complete (seqlock style). A reader notes the sequence of
+ * the latest slot, reads the cells in place, and accepts what it read if the
+ * sequence is still the same afterwards; otherwise it tries again.
+ */
+struct SharedFrameHeader
+{
+    static constexpr std::uint32_t expected_magic   = 0x54485452; // "THTR"
+    static constexpr std::uint32_t expected_version = 1;
+
+    std::uint32_t                   magic;
+    std::uint32_t                   version;
+    std::uint32_t                   width;
+    std::uint32_t                   height;
+    std::uint32_t                   stride;         // cells from one row to the next
+    std::uint32_t                   cell_size;      // bytes per cell
+    std::uint64_t                   slot_bytes;
+    std::array<std::uint64_t, 2>    slot_offset;    // from the start of the region
+
+    std::atomic<std::uint64_t>      frame;          // sequence number of the latest published frame
+    std::atomic<std::uint32_t>      latest;         // slot holding it
+    std::array<std::atomic<std::uint64_t>, 2>   slot_sequence;
+    std::array<std::atomic<std::uint64_t>, 2>   slot_frame;
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free && std::atomic<std::uint32_t>::is_always_lock_free,
+              "shared frames need address-free atomics");
+
+namespace detail
+{
+constexpr size_t align_up(size_t value, size_t alignment) { return (value + alignment - 1) / alignment * alignment; }
+
+// A mapping of a POSIX shared memory object, unmapped on destruction
+class SharedMapping
+{
+public:
+    SharedMapping(const std::string& name, size_t bytes, bool create)
+    {
+        const int fd = ::shm_open(name.c_str(), create ? O_CREAT | O_RDWR : O_RDONLY, 0600);
+        if (fd < 0) throw std::system_error(errno, std::generic_category(), "shm_open " + name);
+
+        if (create && ::ftruncate(fd, static_cast<off_t>(bytes)) != 0)
+        {
+            const int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "ftruncate " + name);
+        }
+        if (!create)
+        {
+            struct stat info {};
+            if (::fstat(fd, &info) != 0)
+            {
+                const int error = errno;
+                ::close(fd);
+                throw std::system_error(error, std::generic_category(), "fstat " + name);
+            }
+            bytes = static_cast<size_t>(info.st_size);
+        }
+
+        void* const address = ::mmap(nullptr, bytes, create ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+        const int error = errno;
+        ::close(fd);
+        if (address == MAP_FAILED) throw std::system_error(error, std::generic_category(), "mmap " + name);
+
+        address_ = static_cast<std::byte*>(address);
+        bytes_ = bytes;
+    }
+
+    ~SharedMapping() { ::munmap(address_, bytes_); }
+
+    SharedMapping(const SharedMapping&) = delete;
+    SharedMapping& operator=(const SharedMapping&) = delete;
+
+    std::byte* data() const { return address_; }
+    size_t size() const { return bytes_; }
+
+private:
+    std::byte*  address_ {nullptr};
+    size_t      bytes_ {0};
+};
+} // namespace detail
+
+/*
+ * The producer side: two screens whose cells live in the shared region, so
+ * actors paint straight into memory the compositor reads. Paint into
+ * acquire(), then publish(); the next acquire() hands out the other slot,
+ * which still holds the frame before the last: clear or repaint all of it.
+ * Calls must alternate: acquiring twice, or publishing what was not acquired,
+ * throws std::logic_error (the sequence would no longer tell readers whether the
+ * slot is being painted).
+ *
+ * The shared memory object `name` (e.g. "/theater") is created or resized,
+ * and removed again on destruction.
+ */
+template<class TCell = char>
+class BasicSharedScreen
+{
+public:
+    BasicSharedScreen(std::string name, size_t width, size_t height)
+    : name_ { std::move(name) },
+      slot_bytes_ { detail::align_up(width * height * sizeof(TCell), 64) },
+      mapping_ { name_, header_bytes + 2 * slot_bytes_, true },
+      header_ { new (mapping_.data()) SharedFrameHeader {
+          SharedFrameHeader::expected_magic, SharedFrameHeader::expected_version,
+          static_cast<std::uint32_t>(width), static_cast<std::uint32_t>(height), static_cast<std::uint32_t>(width),
+          static_cast<std::uint32_t>(sizeof(TCell)), slot_bytes_, { header_bytes, header_bytes + slot_bytes_ },
+          {}, {}, {}, {} } },
+      resources_ { slot_resource(0), slot_resource(1) },
+      screens_ { make_screen<TCell>(width, height, width, &resources_[0]), make_screen<TCell>(width, height, width, &resources_[1]) }
+    {}
+
+    ~BasicSharedScreen() { ::shm_unlink(name_.c_str()); }
+
+    BasicSharedScreen(const BasicSharedScreen&) = delete;
+    BasicSharedScreen& operator=(const BasicSharedScreen&) = delete;
+
+    // Marks the back slot as being painted and returns its screen
+    BasicScreen<TCell>& acquire()
+    {
+        if (painting_) throw std::logic_error("shared screen acquired twice without publishing");
+        painting_ = true;
+        auto& sequence = header_->slot_sequence[back_];
+        sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        return screens_[back_];
+    }
+
+    // Completes the painted back slot and makes it the latest frame; returns its sequence number
+    std::uint64_t publish()
+    {
+        if (!painting_) throw std::logic_error("shared screen published without acquiring");
+        painting_ = false;
+        const auto frame = header_->frame.load(std::memory_order_relaxed) + 1;
+        header_->slot_frame[back_].store(frame, std::memory_order_relaxed);
+        auto& sequence = header_->slot_sequence[back_];
+        sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        header_->latest.store(back_, std::memory_order_release);
+        header_->frame.store(frame, std::memory_order_release);
+        back_ ^= 1;
+        return frame;
+    }
+
+    const SharedFrameHeader& header() const { return *header_; }
+
+private:
+    static constexpr size_t header_bytes = detail::align_up(sizeof(SharedFrameHeader), 64);
+
+    std::pmr::monotonic_buffer_resource slot_resource(size_t slot)
+    {
+        return { mapping_.data() + header_bytes + slot * slot_bytes_, slot_bytes_, std::pmr::null_memory_resource() };
+    }
+
+    const std::string                                   name_;
+    const size_t                                        slot_bytes_;
+    detail::SharedMapping                               mapping_;
+    SharedFrameHeader* const                            header_;
+    std::array<std::pmr::monotonic_buffer_resource, 2>  resources_;
+    std::array<BasicScreen<TCell>, 2>                   screens_;
+    std::uint32_t                                       back_ {0};
+    bool                                                painting_ {false};
+};
+
+using SharedScreen = BasicSharedScreen<char>;
+
+// A consistent frame, viewed in place in the shared region
+template<class TCell>
+struct SharedFrame
+{
+    std::uint64_t   frame;
+    size_t          width;
+    size_t          height;
+    size_t          stride;
+    const TCell*    cells;
+
+    std::span<const TCell> row(size_t y) const { return { cells + y * stride, width }; }
+};
+
+/*
+ * The consumer side, typically in another process. read() calls fn with a
+ * view of the latest frame, directly in shared memory: nothing is copied.
+ * The view may be overwritten while fn runs, so fn must only look at it (or
+ * copy out of it); read() returns the frame number when what fn saw was
+ * consistent and nothing when it was not and its work should be discarded.
+ */
+template<class TCell = char>
+class BasicSharedScreenReader
+{
+public:
+    explicit BasicSharedScreenReader(const std::string& name)
+    : mapping_ { name, 0, false }, header_ { reinterpret_cast<const SharedFrameHeader*>(mapping_.data()) }
+    {
+        if (mapping_.size() < sizeof(SharedFrameHeader) || header_->magic != SharedFrameHeader::expected_magic
+            || header_->version != SharedFrameHeader::expected_version || header_->cell_size != sizeof(TCell))
+            throw std::runtime_error("not a shared frame region of this cell type: " + name);
+
+        // Every row of both slots has to lie within the region, whatever the header claims
+        const std::uint64_t cells = std::uint64_t { header_->stride } * header_->height;
+        const bool slots_inside = std::all_of(header_->slot_offset.begin(), header_->slot_offset.end(), [&](std::uint64_t offset) {
+            return offset >= sizeof(SharedFrameHeader) && offset % alignof(TCell) == 0
+                && offset <= mapping_.size() && header_->slot_bytes <= mapping_.size() - offset;
+        });
+        if (header_->stride < header_->width || cells > header_->slot_bytes / sizeof(TCell) || !slots_inside)
+            throw std::runtime_error("shared frame region has an inconsistent layout: " + name);
+    }
+
+    // The sequence number of the latest published frame (0 before the first)
+    std::uint64_t frame() const { return header_->frame.load(std::memory_order_acquire); }
+
+    template<class F>
+    std::optional<std::uint64_t> read(F&& fn) const
+    {
+        const auto slot = header_->latest.load(std::memory_order_acquire) & 1;
+        const auto& sequence = header_->slot_sequence[slot];
+        const auto before = sequence.load(std::memory_order_acquire);
+        if (before % 2 != 0 || before == 0) return std::nullopt;
+
+        const SharedFrame<TCell> view {
+            header_->slot_frame[slot].load(std::memory_order_relaxed), header_->width, header_->height, header_->stride,
+            reinterpret_cast<const TCell*>(mapping_.data() + header_->slot_offset[slot])
+        };
+        fn(view);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) != before) return std::nullopt;
+        return view.frame;
+    }
+
+    // Copies the latest frame into `into`, retrying until it is consistent; 0 if none was published yet
+    std::uint64_t copy_latest(BasicFramebuffer<TCell>& into) const
+    {
+        while (frame() != 0)
+        {
+            const auto copied = read([&](const SharedFrame<TCell>& view) {
+                for (size_t y { 0 }; y < std::min(view.height, into.height); ++y)
+                {
+                    const auto row = view.row(y);
+                    std::copy_n(row.begin(), std::min(view.width, into.width), into.row(y).begin());
+                }
+            });
+            if (copied) return *copied;
+        }
+        return 0;
+    }
+
+private:
+    detail::SharedMapping           mapping_;
+    const SharedFrameHeader* const  header_;
+};
+
+using SharedScreenReader = BasicSharedScreenReader<char>;
+
+} // namespace val
@@ -0,0 +1,214 @@
+//
+//  snapshot.hpp
+//  playground
+//
+//  A binary snapshot format for display lists, loadable in place.
+//
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "display_list.hpp"
+
+namespace val
+{
+
+/*
+ * A captured frame: the size of the screen it was painted on, its display
+ * commands and their text. Paint closures (TPerformanceBuffer) cannot be
+ * captured; frames produced as display lists can.
+ *
+ * Layout, all little endian:
+ *
+ *   SnapshotHeader                      32 bytes
+ *   DisplayCommand[command_count]       28 bytes each, as in memory
+ *   char[text_bytes]                    the list's text arena
+ *
+ * Commands start 4-aligned and are stored exactly as DisplayCommand is laid
+ * out, so a mapped file is read in place: parse_snapshot only validates. The
+ * padding after `kind` is written as zeros, so equal lists give equal files.
+ */
+struct SnapshotHeader
+{
+    static constexpr std::uint32_t expected_magic   = 0x4e534854; // "THSN"
+    static constexpr std::uint32_t expected_version = 1;
+
+    std::uint32_t   magic;
+    std::uint32_t   version;
+    std::uint32_t   width;
+    std::uint32_t   height;
+    std::uint64_t   command_count;
+    std::uint64_t   text_bytes;
+};
+
+static_assert(sizeof(SnapshotHeader) == 32 && std::is_trivially_copyable_v<SnapshotHeader>);
+static_assert(sizeof(DisplayCommand) == 28 && alignof(DisplayCommand) == 4 && std::is_trivially_copyable_v<DisplayCommand>,
+              "snapshots store display commands as laid out in memory");
+static_assert(std::endian::native == std::endian::little, "snapshots are little endian");
+
+// Frames of a snapshot lie within +-2^24 cells, where whole cells are exact and convert to val::raster::coordinate
+constexpr float snapshot_coordinate_limit = 16777216.0f;
+
+// A validated snapshot, viewing the bytes it was parsed from
+struct SnapshotView
+{
+    size_t                          width;
+    size_t                          height;
+    std::span<const DisplayCommand> commands;
+    std::string_view                text;
+
+    std::string_view text_of(const DisplayCommand& command) const { return text.substr(command.text_offset, command.text_length); }
+};
+
+inline void write_snapshot(std::ostream& out, const DisplayList& list, size_t width, size_t height)
+{
+    const SnapshotHeader header {
+        SnapshotHeader::expected_magic, SnapshotHeader::expected_version,
+        static_cast<std::uint32_t>(width), static_cast<std::uint32_t>(height),
+        list.commands.size(), list.text.size()
+    };
+    out.write(reinterpret_cast<const char*>(&header), sizeof header);
+
+    // Field by field into zeroed records, leaving the padding defined
+    std::array<std::byte, 256 * sizeof(DisplayCommand)> records {};
+    size_t used { 0 };
+    const auto flush = [&] {
+        out.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(used));
+        used = 0;
+    };
+    for (const auto& command : list.commands)
+    {
+        std::byte* const record = records.data() + used;
+        const auto put = [record](size_t offset, const auto& field) { std::memcpy(record + offset, &field, sizeof field); };
+        std::memset(record, 0, sizeof(DisplayCommand));
+        put(offsetof(DisplayCommand, kind), command.kind);
+        put(offsetof(DisplayCommand, left), command.left);
+        put(offsetof(DisplayCommand, right), command.right);
+        put(offsetof(DisplayCommand, top), command.top);
+        put(offsetof(DisplayCommand, bottom), command.bottom);
+        put(offsetof(DisplayCommand, text_offset), command.text_offset);
+        put(offsetof(DisplayCommand, text_length), command.text_length);
+        used += sizeof(DisplayCommand);
+        if (used == records.size()) flush();
+    }
+    flush();
+    out.write(list.text.data(), static_cast<std::streamsize>(list.text.size()));
+    if (!out) throw std::runtime_error("writing snapshot failed");
+}
+
+// Validates `bytes` as a snapshot, frames included; the view is valid as long as the bytes are
+inline SnapshotView parse_snapshot(std::span<const std::byte> bytes)
+{
+    if (bytes.size() < sizeof(SnapshotHeader)) throw std::runtime_error("snapshot truncated");
+
+    SnapshotHeader header {};
+    std::memcpy(&header, bytes.data(), sizeof header);
+    if (header.magic != SnapshotHeader::expected_magic) throw std::runtime_error("not a snapshot");
+    if (header.version != SnapshotHeader::expected_version) throw std::runtime_error("unsupported snapshot version " + std::to_string(header.version));
+
+    const auto available = bytes.size() - sizeof header;
+    if (header.command_count > available / sizeof(DisplayCommand)
+        || header.text_bytes != available - header.command_count * sizeof(DisplayCommand))
+        throw std::runtime_error("snapshot size does not match its header");
+    if (reinterpret_cast<std::uintptr_t>(bytes.data()) % alignof(DisplayCommand) != 0)
+        throw std::runtime_error("snapshot bytes are misaligned");
+
+    const auto* const commands = reinterpret_cast<const DisplayCommand*>(bytes.data() + sizeof header);
+    const auto* const text = reinterpret_cast<const char*>(commands + header.command_count);
+    const SnapshotView view {
+        header.width, header.height,
+        { commands, static_cast<size_t>(header.command_count) },
+        { text, static_cast<size_t>(header.text_bytes) }
+    };
+
+    for (const auto& command : view.commands)
+    {
+        if (command.kind != DisplayCommand::Kind::button) throw std::runtime_error("snapshot holds an unknown command");
+        if (command.text_offset > view.text.size() || command.text_length > view.text.size() - command.text_offset)
+            throw std::runtime_error("snapshot command text out of range");
+        for (const float bound : { command.left, command.right, command.top, command.bottom })
+            if (!std::isfinite(bound) || std::fabs(bound) > snapshot_coordinate_limit)
+                throw std::runtime_error("snapshot command frame out of range");
+    }
+    return view;
+}
+
+// Copies a snapshot into a display list, e.g. for print_buffer
+inline void load_snapshot(const SnapshotView& view, DisplayList& into)
+{
+    into.clear();
+    into.commands.assign(view.commands.begin(), view.commands.end());
+    into.text.assign(view.text);
+}
+
+// A snapshot file mapped read-only
+class MappedSnapshot
+{
+public:
+    explicit MappedSnapshot(const std::string& path)
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::system_error(errno, std::generic_category(), "open " + path);
+
+        struct stat info {};
+        if (::fstat(fd, &info) != 0)
+        {
+            const int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "fstat " + path);
+        }
+        bytes_ = static_cast<size_t>(info.st_size);
+
+        void* const address = bytes_ ? ::mmap(nullptr, bytes_, PROT_READ, MAP_PRIVATE, fd, 0) : nullptr;
+        const int error = errno;
+        ::close(fd);
+        if (address == MAP_FAILED) throw std::system_error(error, std::generic_category(), "mmap " + path);
+        address_ = static_cast<const std::byte*>(address);
+
+        try
+        {
+            view_ = parse_snapshot({ address_, bytes_ });
+        }
+        catch (...)
+        {
+            if (address_) ::munmap(const_cast<std::byte*>(address_), bytes_);
+            throw;
+        }
+    }
+
+    ~MappedSnapshot()
+    {
+        if (address_) ::munmap(const_cast<std::byte*>(address_), bytes_);
+    }
+
+    MappedSnapshot(const MappedSnapshot&) = delete;
+    MappedSnapshot& operator=(const MappedSnapshot&) = delete;
+
+    const SnapshotView& view() const { return view_; }
+
+private:
+    const std::byte*    address_ {nullptr};
+    size_t              bytes_ {0};
+    SnapshotView        view_ {};
+};
+
+} // namespace val
@@ -0,0 +1,63 @@
+//
+//  static_layout.hpp
+//  playground
+//
+//  Layout of scenes known at compile time.
+//
+
+#pragma once
+
+#include <array>
+#include <string_view>
+#include <utility>
+
+#include "typedefs.hpp"
+
+namespace val
+{
+
+namespace detail
+{
+// Stage has const members, so the layout is computed into plain bounds first
+struct Bounds
+{
+    float left {0};
+    float right {0};
+    float top {0};
+    float bottom {0};
+};
+
+template<size_t N, size_t... Idx>
+constexpr std::array<Stage, N> to_stages(const std::array<Bounds, N>& bounds, std::index_sequence<Idx...>)
+{
+    return { Stage { bounds[Idx].left, bounds[Idx].right, bounds[Idx].top, bounds[Idx].bottom }... };
+}
+} // namespace detail
+
+/*
+ * Lays out a fixed array of scripts with a stateless director (for example
+ * the dir::stack::statically directors) and a constexpr measure such as
+ * measure_button. Called in a constexpr context, a static toolbar or menu is
+ * laid out by the compiler and can be checked with static_assert:
+ *
+ *   constexpr auto stages = val::layout_static(stage, {}, dir::stack::statically::horizontally,
+ *                                              measure_button, std::array<std::string_view, 2> { "Ok", "Cancel" });
+ *   static_assert(stages[1].left == 5);
+ */
+template<size_t N, class TDirector, class TMeasure>
+constexpr std::array<Stage, N> layout_static(const Stage& stage, StageLayout layout, const TDirector& director,
+                                             const TMeasure& measure, const std::array<std::string_view, N>& scripts)
+{
+    std::array<detail::Bounds, N> bounds {};
+    bind_director(director, stage, [&](const auto& bound) {
+        for (size_t idx { 0 }; idx < N; ++idx)
+        {
+            const Stage placed = measure(bound.instruct(stage, layout), scripts[idx]);
+            layout = bound.adjust(stage, placed, layout);
+            bounds[idx] = { placed.left, placed.right, placed.top, placed.bottom };
+        }
+    });
+    return detail::to_stages(bounds, std::make_index_sequence<N> {});
+}
+
+} // namespace val
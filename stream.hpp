@@ -0,0 +1,134 @@
+//
+//  stream.hpp
+//  playground
+//
+//  Lazy layout of scripts coming from an input range.
+//
+
+#pragma once
+
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <string_view>
+#include <utility>
+
+#include "typedefs.hpp"
+
+namespace val
+{
+
+struct PlacedScene
+{
+    Stage   stage;
+    size_t  index;      // position of the script in the input
+};
+
+/*
+ * Lays out scripts one at a time as they are pulled from any input range
+ * (a vector, std::views::istream, a coroutine generator...). Only the running
+ * StageLayout and the current scene are held, so memory stays bounded no
+ * matter how long the input is.
+ *
+ * Once a scene would start outside of the stage the stream is full: that
+ * scene is held back (not emitted), iteration ends and no more input is
+ * read. resume() continues on a fresh layout, e.g. the next page, starting
+ * with the held back script.
+ *
+ * Scripts are not copied: the input is only advanced past a script once its
+ * scene is placed, so a held back script is still the current element. The
+ * director and measure are held by value.
+ */
+template<std::input_iterator TIterator, std::sentinel_for<TIterator> TSentinel, class TDirector, class TMeasure>
+class SceneStream
+{
+public:
+    SceneStream(const Stage& stage, const StageLayout& layout, TDirector director, TMeasure measure,
+                TIterator first, TSentinel last)
+    : stage_ { stage }, layout_ { layout }, director_ { std::move(director) }, measure_ { std::move(measure) },
+      input_ { std::move(first) }, last_ { std::move(last) }
+    {}
+
+    // The next placed scene, or nothing once the input is exhausted or the stage is full
+    std::optional<PlacedScene> next()
+    {
+        if (full_ || input_ == last_) return std::nullopt;
+
+        const auto& script = *input_;
+        const Stage placed = measure_(director_.instruct(stage_, layout_), std::string_view { script });
+        if (!(placed.top < stage_.bottom && placed.left < stage_.right))
+        {
+            full_ = true;
+            return std::nullopt;
+        }
+
+        ++input_;
+        layout_ = director_.adjust(stage_, placed, layout_);
+        return PlacedScene { placed, index_++ };
+    }
+
+    bool full() const { return full_; }
+    bool exhausted() const { return input_ == last_; }
+
+    // Continues a full stream with `layout`, starting with the held back script
+    void resume(const StageLayout& layout)
+    {
+        layout_ = layout;
+        full_ = false;
+    }
+
+    const StageLayout& layout() const { return layout_; }
+
+    // Range-for support: each step lays out one more scene
+    class iterator
+    {
+    public:
+        using value_type        = PlacedScene;
+        using difference_type   = std::ptrdiff_t;
+
+        iterator() = default;
+        explicit iterator(SceneStream* stream) : stream_ { stream } { ++*this; }
+
+        const PlacedScene& operator*() const { return *current_; }
+        const PlacedScene* operator->() const { return &*current_; }
+
+        iterator& operator++()
+        {
+            current_.reset();
+            if (auto scene = stream_->next()) current_.emplace(*scene);
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+
+        bool operator==(std::default_sentinel_t) const { return !current_; }
+
+    private:
+        SceneStream*                stream_ {nullptr};
+        std::optional<PlacedScene>  current_ {};
+    };
+
+    iterator begin() { return iterator { this }; }
+    std::default_sentinel_t end() const { return {}; }
+
+private:
+    const Stage                 stage_;
+    StageLayout                 layout_;
+    const TDirector             director_;
+    const TMeasure              measure_;
+    TIterator                   input_;     // the next script, or the held back one
+    TSentinel                   last_;
+    bool                        full_ {false};
+    size_t                      index_ {0};
+};
+
+// A SceneStream over any input range of scripts; the range must outlive the stream
+template<std::ranges::input_range TRange, class TDirector, class TMeasure>
+auto stream_scenes(const Stage& stage, const StageLayout& layout, TDirector director, TMeasure measure,
+                   TRange& scripts)
+{
+    return SceneStream<std::ranges::iterator_t<TRange>, std::ranges::sentinel_t<TRange>, TDirector, TMeasure> {
+        stage, layout, std::move(director), std::move(measure), std::ranges::begin(scripts), std::ranges::end(scripts)
+    };
+}
+
+} // namespace val
@@ -0,0 +1,1127 @@
+//
+//  tests.cpp
+//  playground
+//
+//  Checks of the alternative layout paths against the sequential ones. Build
+//  and run with ./check
+//
+
+// Instrumented, so the sinks can be checked too; no sink is installed otherwise
+#define THEATER_INSTRUMENT 1
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <ranges>
+#include <sstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "typedefs.hpp"
+#include "packed.hpp"
+#include "directors.hpp"
+#include "actors.hpp"
+#include "batch.hpp"
+#include "incremental.hpp"
+#include "display_list.hpp"
+#include "layout_cache.hpp"
+#include "arena.hpp"
+#include "pool.hpp"
+#include "containers.hpp"
+#include "scan.hpp"
+#include "flow.hpp"
+#include "window.hpp"
+#include "shard.hpp"
+#include "measure_cache.hpp"
+#include "scripts.hpp"
+#include "snapshot.hpp"
+#include "async_actors.hpp"
+#include "stream.hpp"
+#include "output.hpp"
+#include "shared_screen.hpp"
+#include "present.hpp"
+#include "instrument.hpp"
+
+#include <sched.h>
+#include <sys/wait.h>
+
+namespace tests
+{
+int failures { 0 };
+
+void expect(bool ok, std::string_view what)
+{
+    if (ok) return;
+    ++failures;
+    std::printf("FAILED: %.*s\n", static_cast<int>(what.size()), what.data());
+}
+
+// packed.hpp: the packed resolvers against resolve_axis, for every def/lnt pairing
+namespace packed
+{
+constexpr float nan = std::numeric_limits<float>::quiet_NaN();
+
+constexpr val::AxisDirection axis(bool strict_low, float low, bool strict_high, float high)
+{
+    return { strict_low ? val::Direction { val::def { low } } : val::Direction { val::lnt { low } },
+             strict_high ? val::Direction { val::def { high } } : val::Direction { val::lnt { high } } };
+}
+
+constexpr bool same_bits(float a, float b) { return std::bit_cast<std::uint32_t>(a) == std::bit_cast<std::uint32_t>(b); }
+
+constexpr bool matches(float low, float high, float incoming)
+{
+    for (const bool strict_low : { false, true })
+        for (const bool strict_high : { false, true })
+        {
+            const auto direction = axis(strict_low, low, strict_high, high);
+            const auto packed = val::pack(direction);
+            if (!same_bits(val::resolve_axis(direction, incoming), val::resolve_axis_packed(packed, incoming))) return false;
+            if (!same_bits(val::resolve_direction(direction.high, incoming), val::resolve_direction_packed(val::pack(direction.high), incoming)))
+                return false;
+        }
+    return true;
+}
+
+static_assert(matches(2, 10, 0) && matches(2, 10, 2) && matches(2, 10, 5) && matches(2, 10, 10) && matches(2, 10, 12));
+static_assert(matches(0.0f, 10, -0.0f) && matches(-0.0f, 0.0f, 0.0f) && matches(5, -0.0f, 0.0f));
+static_assert(matches(2, 10, nan) && matches(nan, 10, 5) && matches(2, nan, 5));
+static_assert(matches(10, 2, 5) && matches(-3.5f, 7.25f, 7.5f));
+
+void check()
+{
+    // Every pairing over a grid, through the batched column resolver
+    const float values[] { -1, -0.0f, 0, 0.5f, 1, 3, 7, nan };
+    std::vector<float> lows, highs, incoming, expected;
+    std::vector<std::uint8_t> strictness;
+    for (const float low : values)
+        for (const float high : values)
+            for (const float in : values)
+                for (const bool strict_low : { false, true })
+                    for (const bool strict_high : { false, true })
+                    {
+                        const auto direction = axis(strict_low, low, strict_high, high);
+                        const auto packed = val::pack(direction);
+                        lows.push_back(packed.low);
+                        highs.push_back(packed.high);
+                        strictness.push_back(packed.strictness);
+                        incoming.push_back(in);
+                        expected.push_back(val::resolve_axis(direction, in));
+                    }
+    std::vector<float> resolved(expected.size());
+    val::resolve_axis_batch({ lows, highs, strictness }, incoming, resolved);
+    bool identical { true };
+    for (size_t idx { 0 }; idx < expected.size(); ++idx) identical &= same_bits(expected[idx], resolved[idx]);
+    expect(identical, "resolve_axis_batch is bit-for-bit resolve_axis");
+}
+} // namespace packed
+
+std::vector<std::string> make_scripts(size_t count)
+{
+    std::vector<std::string> scripts {};
+    scripts.reserve(count);
+    for (size_t idx { 0 }; idx < count; ++idx) scripts.push_back(std::string(idx % 23, static_cast<char>('a' + idx % 26)));
+    return scripts;
+}
+
+bool same_stage(const val::Stage& a, const val::Stage& b)
+{
+    return a.left == b.left && a.right == b.right && a.top == b.top && a.bottom == b.bottom;
+}
+
+bool same_stages(const val::SceneBatch& a, const val::SceneBatch& b)
+{
+    if (a.size() != b.size()) return false;
+    for (size_t idx { 0 }; idx < a.size(); ++idx)
+        if (!same_stage(a.stage(idx), b.stage(idx))) return false;
+    return true;
+}
+
+// The sequential reference every other path is compared with
+val::SceneBatch reference(const val::Stage& stage, const val::StageLayout& layout, std::span<const std::string> scripts, bool horizontal = false)
+{
+    val::SceneBatch batch {};
+    if (horizontal) layout_batch(stage, layout, dir::stack::statically::horizontally, measure_button, scripts, batch);
+    else layout_batch(stage, layout, dir::stack::statically::vertically, measure_button, scripts, batch);
+    return batch;
+}
+
+// batch.hpp: chaining slices into one batch
+void batch()
+{
+    const auto scripts = make_scripts(1'000);
+    const val::Stage stage { 0, 80, 0, 5'000 };
+    const auto whole = reference(stage, {}, scripts);
+
+    val::SceneBatch chained {};
+    val::StageLayout layout {};
+    size_t reallocations { 0 };
+    for (size_t start { 0 }; start < scripts.size(); start += 10)
+    {
+        const auto capacity = chained.capacity();
+        layout = layout_batch(stage, layout, dir::stack::statically::vertically, measure_button,
+                              std::span { scripts }.subspan(start, 10), chained);
+        reallocations += chained.capacity() != capacity;
+    }
+    expect(same_stages(whole, chained), "layout_batch chained over slices equals one call");
+    expect(reallocations <= 8, "chained layout_batch grows geometrically");
+    expect(chained.script_index[15] == 5, "script_index counts within each call");
+}
+// incremental.hpp: relayout against a full layout of the new scripts
+void incremental()
+{
+    const val::Stage tall { 0, 80, 0, 10'000 };
+    auto scripts = make_scripts(1'000);
+    val::IncrementalLayout vertical { tall, {}, dir::stack::statically::vertically, measure_button };
+    expect(vertical.layout(scripts) == 1'000, "incremental layout lays out every script");
+    expect(same_stages(vertical.scenes(), reference(tall, {}, scripts)), "incremental layout equals layout_batch");
+
+    // A wider label in a vertical stack moves nothing after it
+    scripts[500] = "a label wider than before";
+    const size_t changed[] { 500 };
+    expect(vertical.relayout(scripts, changed) == 1, "a vertical stack stops right after the changed script");
+    expect(same_stages(vertical.scenes(), reference(tall, {}, scripts)), "changed relayout equals layout_batch");
+
+    scripts.resize(800);
+    expect(vertical.relayout(scripts, {}) == 0, "shrinking lays out nothing");
+    expect(same_stages(vertical.scenes(), reference(tall, {}, scripts)), "shrunk relayout equals layout_batch");
+    expect(vertical.final_layout() == vertical.checkpoints()[800], "shrunk relayout ends at the last checkpoint");
+
+    const auto more = make_scripts(1'200);
+    scripts.insert(scripts.end(), more.begin() + 800, more.end());
+    expect(vertical.relayout(scripts, {}) == 400, "growing lays out the tail only");
+    expect(same_stages(vertical.scenes(), reference(tall, {}, scripts)), "grown relayout equals layout_batch");
+
+    // In a horizontal stack a wider label moves everything after it
+    const val::Stage wide { 0, 30'000, 0, 3 };
+    auto row = make_scripts(1'000);
+    val::IncrementalLayout horizontal { wide, {}, dir::stack::statically::horizontally, measure_button };
+    horizontal.layout(row);
+    row[900] += "wider";
+    const size_t widened[] { 900, 950 };
+    expect(horizontal.relayout(row, widened) == 100, "a horizontal stack relays out the whole tail once");
+    expect(same_stages(horizontal.scenes(), reference(wide, {}, row, true)), "horizontal relayout equals layout_batch");
+}
+// arena.hpp: after warm-up a whole frame is served by the arena
+void arena()
+{
+    const auto scripts = make_scripts(1'000);
+    const val::Stage stage { 0, 80, 0, 4'004 };
+    auto screen = val::make_screen(80, 4'004);
+    val::FrameArena arena { 1'024 };
+
+    size_t last_frame_allocations { 0 };
+    for (size_t frame { 0 }; frame < 8; ++frame)
+    {
+        {
+            val::DisplayList list { arena.resource() };
+            produce_display_list(stage, {}, dir::stack::statically::vertically, measure_button, scripts, list);
+            val::rasterize(list, screen);
+        }
+        last_frame_allocations = arena.frame_heap_allocations();
+        arena.reset();
+    }
+    expect(arena.heap_allocations() > 1, "the arena grew while warming up");
+    expect(last_frame_allocations == 0, "a warm frame makes no heap allocations");
+}
+// containers.hpp: the merged display list does not depend on the pool
+void containers()
+{
+    const auto column = [](float left, float right, const val::Director& director, size_t count) {
+        return val::Container { { left, right, 0, 400 }, { left, 0, 0, 0, 0, 0 }, director, measure_button, make_scripts(count) };
+    };
+    auto left = column(0, 40, dir::stack::vertically, 60);
+    left.children.push_back(column(2, 38, dir::stack::vertically, 20));
+    auto right = column(40, 200, dir::stack::horizontally, 30);
+    right.children.push_back(column(42, 198, dir::stack::magically, 40));
+    val::Container root { { 0, 200, 0, 400 }, {}, dir::stack::vertically, measure_button, make_scripts(5), { left, right } };
+
+    val::DisplayList sequential {};
+    for (const auto* container : { &root, &root.children[0], &root.children[0].children[0], &root.children[1], &root.children[1].children[0] })
+    {
+        val::DisplayList part {};
+        produce_display_list(container->stage, container->layout, container->director, container->measure, container->scripts, part);
+        sequential.append(part);
+    }
+
+    expect(sequential.size() == 155, "every container is laid out");
+    for (const size_t threads : { 0, 1, 4 })
+    {
+        val::ThreadPool pool { threads };
+        val::DisplayList parallel {};
+        val::layout_containers(root, pool, parallel);
+        expect(parallel.commands == sequential.commands && parallel.text == sequential.text,
+               "layout_containers equals the sequential pre-order layout on " + std::to_string(threads) + " threads");
+    }
+}
+// scan.hpp: the parallel scan places exactly like the sequential producer
+void scan()
+{
+    const auto scripts = make_scripts(5'000);
+    struct Case { const char* name; val::StackAxis axis; val::Stage stage; float margin; };
+    const Case cases[] {
+        { "vertical", val::StackAxis::vertical, { 0, 80, 0, 20'004 }, 0 },
+        { "vertical clamped", val::StackAxis::vertical, { 0, 80, 0, 9'000 }, 1 },
+        { "vertical fractional margin", val::StackAxis::vertical, { 0, 80, 0, 30'000 }, 0.25f },
+        { "horizontal", val::StackAxis::horizontal, { 0, 80'016, 0, 3 }, 0 },
+        { "horizontal clamped", val::StackAxis::horizontal, { 0, 30'000, 0, 3 }, 2 },
+    };
+    for (const size_t threads : { 1, 2, 4 })
+    {
+        val::ThreadPool pool { threads };
+        for (const auto& test : cases)
+        {
+            const bool horizontal = test.axis == val::StackAxis::horizontal;
+            val::StageLayout initial {};
+            (horizontal ? initial.horizontal_margin : initial.vertical_margin) = test.margin;
+
+            val::SceneBatch sequential {}, scanned {};
+            const auto expected = horizontal
+                ? layout_batch(test.stage, initial, dir::stack::statically::horizontally, measure_button, scripts, sequential)
+                : layout_batch(test.stage, initial, dir::stack::statically::vertically, measure_button, scripts, sequential);
+            const auto layout = val::scan_layout(test.axis, test.stage, initial, measure_button, scripts, pool, scanned);
+            expect(same_stages(sequential, scanned) && layout == expected,
+                   std::string { "scan_layout " } + test.name + " equals layout_batch on " + std::to_string(threads) + " threads");
+        }
+    }
+}
+// actors.hpp: the split button actor performs like renderer
+void split_actor()
+{
+    const val::Instruction instruction { { val::def { 3 }, val::lnt { 60 } }, { val::def { 2 }, val::lnt { 20 } } };
+    const auto split = button_actor.perfom(instruction, "Split button");
+    const auto whole = renderer(instruction, "Split button");
+    expect(same_stage(split.first, whole.first), "button_actor measures like renderer");
+
+    auto painted_split = val::make_screen(60, 20), painted_whole = val::make_screen(60, 20);
+    split.second(painted_split);
+    whole.second(painted_whole);
+    expect(std::equal(painted_split.buffer.cells.begin(), painted_split.buffer.cells.end(), painted_whole.buffer.cells.begin()),
+           "button_actor paints like renderer");
+}
+// stream.hpp: pages of a stream equal layout_batch of the same scripts
+void stream()
+{
+    const auto scripts = make_scripts(250);
+    const val::Stage page { 0, 80, 0, 100 };
+    std::istringstream source {};
+    {
+        std::string text {};
+        for (const auto& script : scripts) text += "x" + script + "\n"; // istream words must not be empty
+        source.str(text);
+    }
+    std::vector<std::string> words {};
+    for (const auto& script : scripts) words.push_back("x" + script);
+
+    // A temporary director and measure, and an input-only range
+    auto input = std::views::istream<std::string>(source);
+    auto stream = val::stream_scenes(page, {}, val::BasicDirector { dir::stack::kernel::vertical_next, dir::stack::kernel::vertical_adjust },
+                                     [](const val::Instruction& instruction, std::string_view script) { return measure_button(instruction, script); },
+                                     input);
+
+    size_t first { 0 }, pages { 0 };
+    bool identical { true };
+    while (!stream.exhausted())
+    {
+        val::SceneBatch streamed {};
+        for (const auto& scene : stream) streamed.push_back(scene.stage, scene.index);
+        const auto count = streamed.size();
+        const auto expected = reference(page, {}, std::span { words }.subspan(first, count));
+        identical &= count > 0 && same_stages(streamed, expected);
+        identical &= stream.exhausted() || reference(page, {}, std::span { words }.subspan(first, count + 1)).stage(count).top >= page.bottom;
+        first += count;
+        ++pages;
+        stream.resume({});
+    }
+    expect(identical && first == words.size(), "every page of stream_scenes equals layout_batch");
+    expect(pages == 8, "stream_scenes pages at the stage bottom"); // 34 buttons of 3 rows per page
+}
+// output.hpp: submit then destroy, over and over; destruction must never hang
+void async_output()
+{
+    std::atomic<bool> done { false };
+    std::jthread watchdog { [&done] {
+        for (size_t waited { 0 }; waited < 600 && !done.load(); ++waited) std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        if (done.load()) return;
+        std::printf("FAILED: AsyncOutput destruction hangs\n");
+        std::_Exit(1);
+    } };
+
+    bool accounted { true };
+    for (size_t round { 0 }; round < 2'000; ++round)
+    {
+        std::atomic<size_t> presented { 0 };
+        const size_t submits = 1 + round % 3;
+        size_t dropped { 0 };
+        {
+            val::AsyncOutput output { 8, 2, [&presented](const val::Screen&) { presented.fetch_add(1); } };
+            for (size_t idx { 0 }; idx < submits; ++idx)
+            {
+                output.acquire().buffer.clear(static_cast<char>('a' + idx));
+                output.submit();
+                if (round % 7 == 0) std::this_thread::yield();
+            }
+            dropped = output.frames_dropped();
+        }
+        // Every submitted frame was either presented or replaced by a newer one
+        accounted &= presented.load() + dropped == submits;
+    }
+    done.store(true);
+    expect(accounted, "AsyncOutput presents or drops every submitted frame");
+}
+void flow()
+{
+    auto scripts = make_scripts(500);
+    scripts[7] = std::string(200, 'w');
+    const val::Stage stage { 3, 43, 0, 100'000 };
+    const auto width = [](const val::SceneBatch& batch, size_t idx) { return batch.right[idx] - batch.left[idx]; };
+    const auto all = [](const val::SceneBatch& batch, const auto& ok) {
+        for (size_t idx { 0 }; idx < batch.size(); ++idx) if (!ok(idx)) return false;
+        return batch.size() > 0;
+    };
+    const auto on_stage = [&](const val::SceneBatch& batch) {
+        return all(batch, [&](size_t idx) { return batch.left[idx] >= stage.left && batch.right[idx] <= stage.right; });
+    };
+
+    val::SceneBatch filled {};
+    val::layout_flex_wrap(stage, {}, measure_button, scripts, filled);
+    expect(on_stage(filled), "flex_wrap keeps every item, even one wider than the stage, on the stage");
+    expect(all(filled, [&](size_t idx) { return idx + 1 == filled.size() || filled.top[idx + 1] != filled.top[idx] || filled.right[idx] < filled.left[idx + 1]; }),
+           "flex_wrap items of a row do not overlap");
+    expect(all(filled, [&](size_t idx) { return (idx + 1 < filled.size() && filled.top[idx + 1] == filled.top[idx]) || filled.right[idx] == stage.right; }),
+           "flex_wrap fill shares out the whole row");
+
+    const val::ItemConstraints capped { val::ItemWidth::fill, 0, 9 };
+    val::SceneBatch narrow {};
+    val::layout_flex_wrap(stage, {}, measure_button, scripts, narrow, capped);
+    expect(on_stage(narrow) && all(narrow, [&](size_t idx) { return width(narrow, idx) <= 9; }), "flex_wrap fill stops at max_width");
+
+    const val::ItemConstraints floored { val::ItemWidth::natural, 12 };
+    val::SceneBatch natural {};
+    val::layout_flex_wrap(stage, {}, measure_button, scripts, natural, floored);
+    expect(on_stage(natural) && all(natural, [&](size_t idx) { return width(natural, idx) >= 12; }), "flex_wrap natural holds min_width");
+    expect(width(natural, 20) == 20 + 2 * button::border_size,
+           "flex_wrap natural keeps the natural width above min_width");
+
+    val::SceneBatch grid {};
+    val::layout_grid(stage, {}, measure_button, scripts, 3, grid, floored);
+    expect(on_stage(grid) && all(grid, [&](size_t idx) { return width(grid, idx) == 12; }),
+           "layout_grid caps min_width at the column");
+
+    val::SceneBatch columns {};
+    val::layout_grid(stage, {}, measure_button, scripts, 4, columns, { val::ItemWidth::natural, 5 });
+    expect(on_stage(columns) && all(columns, [&](size_t idx) { return width(columns, idx) >= 5 && width(columns, idx) <= 9; }),
+           "layout_grid natural stays between min_width and the column");
+}
+
+void layout_cache()
+{
+    auto scripts = make_scripts(300);
+    const val::Stage stage { 0, 80, 0, 2'000 };
+
+    // Unnamed, so both are called "director"
+    const val::Director down { dir::stack::vertical_next, dir::stack::vertical_adjust };
+    const val::Director spaced { dir::stack::vertical_next, [](const val::Stage& on, const val::performance& placed, const val::StageLayout& layout) {
+        auto next = dir::stack::vertical_adjust(on, placed, layout);
+        next.y_offset += 1;
+        return next;
+    } };
+    const auto taller = [](const val::Instruction& instruction, std::string_view script) {
+        const auto placed = measure_button(instruction, script);
+        return val::Stage { placed.left, placed.right, placed.top, placed.bottom + 1 };
+    };
+
+    val::LayoutCache cache {};
+    const auto cached = [&](const auto& director, const auto& measure) {
+        val::DisplayList list {};
+        val::produce_display_list_cached(cache, stage, {}, director, measure, scripts, list);
+        return list;
+    };
+    const auto uncached = [&](const auto& director, const auto& measure) {
+        val::DisplayList list {};
+        produce_display_list(stage, {}, director, measure, scripts, list);
+        return list;
+    };
+
+    expect(cached(down, measure_button) == uncached(down, measure_button) && cached(down, taller) == uncached(down, taller),
+           "layout_cache tells measures apart");
+    expect(cached(spaced, measure_button) == uncached(spaced, measure_button), "layout_cache tells unnamed directors apart");
+    expect(cache.misses() == 3 && cache.hits() == 0 && cache.size() == 3, "layout_cache misses on every new director and measure");
+
+    for (auto& script : scripts) std::ranges::fill(script, 'z');
+    expect(cached(down, measure_button) == uncached(down, measure_button) && cache.hits() == 1,
+           "layout_cache hits when only the text changes, and records the new text");
+    scripts[5] += "longer";
+    expect(cached(down, measure_button) == uncached(down, measure_button) && cache.misses() == 4,
+           "layout_cache misses when a measurement changes");
+
+    const val::BasicSet set { stage, {}, val::BasicCrew { dir::stack::statically::vertically, button_actor } };
+    TPerformanceBuffer scenes {}, expected {};
+    for (int round { 0 }; round < 2; ++round)
+    {
+        scenes.clear();
+        val::produce_scenes_cached(cache, set, scripts, scenes);
+    }
+    produce_scenes(set, expected, scripts);
+    expect(cache.hits() == 2 && std::ranges::equal(scenes, expected, [](const auto& a, const auto& b) { return same_stage(a.first, b.first); }),
+           "produce_scenes_cached places like produce_scenes");
+}
+
+// Views interned in a ScriptTable go everywhere the owning strings go, with the same result
+void interned_scripts()
+{
+    auto scripts = make_scripts(2'000);
+    for (size_t idx { 0 }; idx < scripts.size(); idx += 3) scripts[idx] = scripts[0];
+    val::ScriptTable table {};
+    const std::vector<std::string_view> views = table.intern_all(scripts);
+    expect(table.size() < scripts.size(), "ScriptTable stores equal texts once");
+
+    const val::Stage stage { 0, 80, 0, 10'000 };
+    const auto same = [](const auto& produce) {
+        val::SceneBatch a {}, b {};
+        const auto first = produce(a, true), second = produce(b, false);
+        return first == second && same_stages(a, b);
+    };
+    const auto pick = [&](bool owned, const auto& fn) { return owned ? fn(scripts) : fn(views); };
+
+    expect(same([&](val::SceneBatch& into, bool owned) {
+        return pick(owned, [&](const auto& list) { return layout_batch(stage, {}, dir::stack::statically::vertically, measure_button, list, into); });
+    }), "layout_batch takes interned views");
+
+    val::DisplayList owned_list {}, viewed_list {};
+    produce_display_list(stage, {}, dir::stack::statically::vertically, measure_button, scripts, owned_list);
+    produce_display_list(stage, {}, dir::stack::statically::vertically, measure_button, views, viewed_list);
+    expect(owned_list == viewed_list, "produce_display_list takes interned views");
+
+    val::ThreadPool pool { 2 };
+    expect(same([&](val::SceneBatch& into, bool owned) {
+        return pick(owned, [&](const auto& list) { return val::scan_layout(val::StackAxis::vertical, stage, {}, measure_button, list, pool, into); });
+    }), "scan_layout takes interned views");
+
+    expect(same([&](val::SceneBatch& into, bool owned) {
+        return pick(owned, [&](const auto& list) { return val::layout_flex_wrap(stage, {}, measure_button, list, into); });
+    }) && same([&](val::SceneBatch& into, bool owned) {
+        return pick(owned, [&](const auto& list) { return val::layout_grid(stage, {}, measure_button, list, 3, into); });
+    }), "flow layouts take interned views");
+
+    const auto index = val::RowIndex::measured(stage, {}, measure_button, views);
+    expect(same([&](val::SceneBatch& into, bool owned) {
+        pick(owned, [&](const auto& list) { val::layout_window(stage, index, measure_button, list, { 300, 420 }, 2, into); return 0; });
+        return 0;
+    }), "RowIndex and layout_window take interned views");
+
+    const val::TileGrid wall { stage, 2, 2 };
+    const auto summary = val::StackSummary::measured(stage, {}, measure_button, views);
+    expect(summary.rows() == views.size() && same([&](val::SceneBatch& into, bool owned) {
+        pick(owned, [&](const auto& list) { val::layout_tile(stage, summary.index(), measure_button, list, wall.tile(1), into); return 0; });
+        return 0;
+    }), "StackSummary and layout_tile take interned views");
+
+    val::IncrementalLayout owned_layout { stage, val::StageLayout {}, dir::stack::statically::vertically, measure_button };
+    val::IncrementalLayout viewed_layout { stage, val::StageLayout {}, dir::stack::statically::vertically, measure_button };
+    owned_layout.layout(scripts);
+    viewed_layout.layout(views);
+    expect(same_stages(owned_layout.scenes(), viewed_layout.scenes()), "IncrementalLayout takes interned views");
+
+    val::LayoutCache cache {};
+    val::DisplayList cached_list {};
+    val::produce_display_list_cached(cache, stage, {}, dir::stack::statically::vertically, measure_button, views, cached_list);
+    expect(cached_list == owned_list, "LayoutCache takes interned views");
+
+    const val::MeasureCache measure_cache { measure_button };
+    val::SceneBatch measured {};
+    layout_batch(stage, {}, dir::stack::statically::vertically, std::cref(measure_cache), views, measured);
+    expect(same_stages(measured, reference(stage, {}, scripts)) && measure_cache.misses() == measure_cache.size(), "MeasureCache measures interned views");
+}
+
+/*
+ * A forked reader only ever accepts frames painted all over with one cell,
+ * while the writer paints every frame with the next one.
+ */
+void shared_screen()
+{
+    const std::string name = "/theater_check_" + std::to_string(::getpid());
+    val::SharedScreen screen { name, 64, 16 };
+    constexpr std::uint64_t frames = 2'000;
+
+    std::fflush(nullptr); // or the reader writes out what is buffered a second time
+    const pid_t reader = ::fork();
+    if (reader == 0)
+    {
+        int status = 0;
+        try
+        {
+            const val::SharedScreenReader shared { name };
+            std::uint64_t accepted { 0 };
+            do
+            {
+                bool uniform = true;
+                const auto frame = shared.read([&](const val::SharedFrame<char>& view) {
+                    for (size_t y { 0 }; y < view.height; ++y)
+                        for (const char cell : view.row(y)) uniform &= cell == view.row(0)[0];
+                });
+                if (frame && !uniform) status = 1;
+                if (frame) ++accepted;
+            } while (shared.frame() < frames);
+            if (accepted == 0) status = 1;
+        }
+        catch (...) { status = 2; }
+        std::fflush(nullptr);
+        ::_exit(status);
+    }
+
+    for (std::uint64_t frame { 1 }; frame <= frames; ++frame)
+    {
+        screen.acquire().buffer.clear(static_cast<char>('a' + frame % 26));
+        screen.publish();
+        if (frame % 16 == 0) ::sched_yield();
+    }
+    int status = -1;
+    ::waitpid(reader, &status, 0);
+    expect(WIFEXITED(status) && WEXITSTATUS(status) == 0, "forked reader sees only whole frames");
+
+    screen.acquire();
+    bool refused_acquire = false, refused_publish = false;
+    try { screen.acquire(); } catch (const std::logic_error&) { refused_acquire = true; }
+    screen.publish();
+    try { screen.publish(); } catch (const std::logic_error&) { refused_publish = true; }
+    expect(refused_acquire && refused_publish, "shared screen refuses to acquire twice or publish unacquired");
+
+    // A reader never trusts a header whose rows would run past its slots
+    {
+        const int fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+        void* const region = ::mmap(nullptr, sizeof(val::SharedFrameHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        auto& header = *static_cast<val::SharedFrameHeader*>(region);
+        const auto check = [&](std::string_view what) {
+            bool rejected = false;
+            try { val::SharedScreenReader { name }; } catch (const std::runtime_error&) { rejected = true; }
+            expect(rejected, what);
+        };
+        header.stride = 32;
+        check("shared screen reader rejects a stride below the width");
+        header.stride = 128;
+        check("shared screen reader rejects rows past the slot");
+        header.stride = 64;
+        header.slot_bytes *= 4;
+        check("shared screen reader rejects slots past the region");
+        ::munmap(region, sizeof(val::SharedFrameHeader));
+    }
+}
+
+void snapshot()
+{
+    const auto scripts = make_scripts(100);
+    val::DisplayList list {};
+    produce_display_list(val::Stage { 0, 80, 0, 400 }, {}, dir::stack::statically::vertically, measure_button, scripts, list);
+
+    // The same commands with garbage in their padding
+    val::DisplayList dirty = list;
+    for (auto& command : dirty.commands) std::memset(reinterpret_cast<std::byte*>(&command) + 1, 0xab, offsetof(val::DisplayCommand, left) - 1);
+
+    const auto written = [](const val::DisplayList& from) {
+        std::ostringstream out {};
+        val::write_snapshot(out, from, 80, 400);
+        const auto text = std::move(out).str();
+        std::vector<std::byte> bytes(text.size());
+        std::memcpy(bytes.data(), text.data(), text.size());
+        return bytes;
+    };
+    auto bytes = written(list);
+    expect(bytes == written(dirty), "snapshots of equal lists are equal, whatever their padding");
+
+    val::DisplayList loaded {};
+    val::load_snapshot(val::parse_snapshot(bytes), loaded);
+    expect(loaded == list, "snapshots load back the list they were written from");
+
+    const auto rejected = [&](float bound) {
+        auto hostile = bytes;
+        std::memcpy(hostile.data() + sizeof(val::SnapshotHeader) + offsetof(val::DisplayCommand, right), &bound, sizeof bound);
+        try { val::parse_snapshot(hostile); } catch (const std::runtime_error&) { return true; }
+        return false;
+    };
+    expect(rejected(std::numeric_limits<float>::quiet_NaN()) && rejected(std::numeric_limits<float>::infinity()) && rejected(-1e30f),
+           "parse_snapshot rejects frames that are not finite or out of range");
+}
+
+// Whole-cell layouts in int32_t and int16_t place every stage where the float layout does
+void integer_cells()
+{
+    // Horizontal stacks stop short of the stage's right end: past it, measure_button has no width to offer
+    const auto scripts = make_scripts(1'000);
+    struct Case { const char* name; val::Stage stage; val::StageLayout layout; };
+    const Case cases[] {
+        { "vertical", { 0, 80, 0, 4'004 }, {} },
+        { "vertical clamped, with margins", { 2, 60, 3, 2'500 }, { 0, 0, 1, 2, 0, 0 } },
+        { "horizontal", { 0, 30'000, 0, 3 }, {} },
+        { "horizontal with margins", { 5, 20'000, 0, 7 }, { 0, 0, 3, 1, 0, 0 } },
+    };
+
+    const auto same_as_float = [&]<class T>(const Case& test, const auto& director) {
+        const auto cells = [](float value) { return static_cast<T>(value); };
+        const val::BasicStage<T> stage { cells(test.stage.left), cells(test.stage.right), cells(test.stage.top), cells(test.stage.bottom) };
+        const val::BasicStageLayout<T> layout {
+            cells(test.layout.x_offset), cells(test.layout.y_offset), cells(test.layout.horizontal_margin),
+            cells(test.layout.vertical_margin), cells(test.layout.x_size), cells(test.layout.y_size)
+        };
+
+        val::SceneBatch expected {};
+        val::BasicSceneBatch<T> placed {};
+        const auto expected_layout = layout_batch(test.stage, test.layout, director, measure_button, scripts, expected);
+        const auto final_layout = layout_batch(stage, layout, director, measure_button, scripts, placed);
+
+        bool same = placed.size() == expected.size()
+            && static_cast<float>(final_layout.x_offset) == expected_layout.x_offset
+            && static_cast<float>(final_layout.y_offset) == expected_layout.y_offset;
+        for (size_t idx { 0 }; same && idx < placed.size(); ++idx)
+        {
+            const auto stage_at = placed.stage(idx);
+            same = same_stage({ static_cast<float>(stage_at.left), static_cast<float>(stage_at.right),
+                                static_cast<float>(stage_at.top), static_cast<float>(stage_at.bottom) }, expected.stage(idx));
+        }
+        return same;
+    };
+
+    for (const auto& test : cases)
+    {
+        const bool horizontal = test.stage.aspect() == val::Stage::Aspect::horizontal;
+        const auto check = [&](const auto& director, std::string_view how) {
+            expect(same_as_float.template operator()<std::int32_t>(test, director), std::string { "int32_t " } + test.name + " " + std::string { how } + " equals float");
+            expect(same_as_float.template operator()<std::int16_t>(test, director), std::string { "int16_t " } + test.name + " " + std::string { how } + " equals float");
+        };
+        if (horizontal) check(dir::stack::statically::horizontally, "horizontally");
+        else check(dir::stack::statically::vertically, "vertically");
+        check(dir::stack::statically::magically, "magically");
+    }
+}
+
+/*
+ * Scripts starting with "icon" wait for a value before they are measured:
+ * settling has to end where laying out the final sizes at once does, and a
+ * measurement that fails has to leave its scene pending.
+ */
+void async_layout()
+{
+    auto scripts = make_scripts(300);
+    for (size_t idx { 0 }; idx < scripts.size(); idx += 37) scripts[idx] = "icon " + scripts[idx];
+    const auto icons = static_cast<size_t>(std::ranges::count_if(scripts, [](std::string_view script) { return script.starts_with("icon"); }));
+    const val::Stage stage { 0, 80, 0, 2'000 };
+
+    std::optional<val::Pending<float>> metrics {};
+    const auto with_icon = [&metrics](val::Stage measured) -> val::Measurement {
+        const float grow = co_await *metrics;
+        if (grow < 0) throw std::runtime_error("no metrics");
+        co_return val::Stage { measured.left, measured.right, measured.top, measured.bottom + grow };
+    };
+    const auto measure = [&](const val::Instruction& instruction, std::string_view script) -> val::Measurement {
+        const auto measured = measure_button(instruction, script);
+        if (!script.starts_with("icon")) return measured;
+        return with_icon(measured);
+    };
+    const val::BasicAsyncActor actor { measure, paint_button, measure_button };
+
+    for (const float grow : { 0.0f, 2.0f })
+    {
+        metrics.emplace();
+        val::AsyncLayout layout { stage, {}, dir::stack::statically::vertically, actor };
+        expect(layout.layout(scripts) == icons, "async layout leaves the waiting scenes pending");
+
+        metrics->set(grow);
+        const size_t relaid = layout.settle();
+        const auto final_measure = [grow](const val::Instruction& instruction, std::string_view script) {
+            const auto measured = measure_button(instruction, script);
+            return val::Stage { measured.left, measured.right, measured.top, measured.bottom + (script.starts_with("icon") ? grow : 0) };
+        };
+        val::SceneBatch expected {};
+        const auto expected_layout = layout_batch(stage, {}, dir::stack::statically::vertically, final_measure, scripts, expected);
+        expect(layout.pending() == 0 && same_stages(layout.scenes(), expected) && layout.final_layout() == expected_layout,
+               "settled async layout equals laying out the final sizes");
+        // Unchanged sizes relay the completed scenes alone; grown ones move everything from the first icon on
+        expect(relaid == (grow == 0 ? icons : scripts.size()), "settle stops as soon as the layouts converge");
+    }
+
+    metrics.emplace();
+    val::AsyncLayout failing { stage, {}, dir::stack::statically::vertically, actor };
+    failing.layout(scripts);
+    metrics->set(-1);
+    bool thrown = false;
+    try { failing.settle(); } catch (const std::runtime_error&) { thrown = true; }
+    expect(thrown && failing.is_pending(0), "a failed measurement rethrows and leaves its scene pending");
+
+    auto screen = val::make_screen(80, 40);
+    failing.paint(screen);
+    expect(screen.buffer.row(0)[0] == ' ' && screen.buffer.row(3)[0] == '|', "the failed scene stays blank when painting");
+}
+
+/*
+ * A 2x4 wall: three instances measure a shard each and exchange summaries in
+ * their wire form, then every tile lays out exactly the stages of the full
+ * layout that intersect it.
+ */
+void tile_grid()
+{
+    const auto scripts = make_scripts(3'001);
+    const val::Stage stage { 0, 80, 0, 12'008 };
+    const val::StageLayout initial { 0, 2, 0, 1, 0, 0 };
+    const val::TileGrid wall { stage, 2, 4 };
+
+    val::SceneBatch full {};
+    layout_batch(stage, initial, dir::stack::statically::vertically, measure_button, scripts, full);
+
+    constexpr size_t shards = 3;
+    val::StackSummary summary { initial };
+    size_t covered { 0 };
+    for (size_t shard { 0 }; shard < shards; ++shard)
+    {
+        const auto [begin, end] = val::shard_range(scripts.size(), shard, shards);
+        expect(begin == covered, "shard ranges follow each other");
+        covered = end;
+
+        std::ostringstream out {};
+        val::StackSummary::measured(stage, initial, measure_button, std::span { scripts }.subspan(begin, end - begin)).write(out);
+        const auto wire = std::move(out).str();
+        summary.append(val::StackSummary::parse(std::as_bytes(std::span { wire })));
+    }
+    expect(covered == scripts.size() && summary.rows() == scripts.size(), "shards cover every script once");
+
+    const auto index = summary.index();
+    size_t placed { 0 };
+    for (size_t idx { 0 }; idx < wall.size(); ++idx)
+    {
+        const auto tile = wall.tile(idx);
+        val::SceneBatch expected {}, laid {};
+        for (size_t row { 0 }; row < full.size(); ++row)
+        {
+            const auto at = full.stage(row);
+            if (at.right > tile.left && at.left < tile.right && at.bottom >= tile.top && at.top < tile.bottom) expected.push_back(at, row);
+        }
+        val::layout_tile(stage, index, measure_button, scripts, tile, laid);
+        expect(same_stages(laid, expected) && std::ranges::equal(laid.script_index, expected.script_index),
+               "tile " + std::to_string(idx) + " lays out exactly the stages intersecting it");
+        placed += laid.size();
+    }
+    expect(placed >= full.size(), "every stage lands on a tile");
+}
+
+// The exact bytes a presenter writes for a frame, and what it counted
+void presenter()
+{
+    std::ostringstream out {};
+    val::TerminalPresenter presenter { out };
+    const auto presented = [&](const val::Screen& screen) {
+        out.str({});
+        presenter.present(screen);
+        return out.str();
+    };
+    const auto full = [](const val::Screen& screen, bool clear) {
+        std::string bytes = clear ? "\x1b[2J" : "";
+        for (size_t y { 0 }; y < screen.height; ++y)
+        {
+            const auto row = screen.buffer.row(y);
+            bytes += "\x1b[" + std::to_string(y + 1) + ";1H" + std::string { row.begin(), row.end() };
+        }
+        return bytes;
+    };
+
+    auto screen = val::make_screen(20, 4);
+    expect(presented(screen) == full(screen, true) && presenter.last().full_repaint && presenter.last().spans_written == 4,
+           "the first frame is repainted completely, after clearing");
+
+    screen.buffer.row(1)[5] = 'X';
+    expect(presented(screen) == "\x1b[2;6HX", "a single changed cell is one cursor move and one cell");
+    expect(!presenter.last().full_repaint && presenter.last().cells_changed == 1 && presenter.last().spans_written == 1
+           && presenter.last().bytes_written == 7, "a single changed cell is counted as one span");
+
+    // Changes at most merge_gap - 1 unchanged cells apart share a span, further apart they do not
+    screen.buffer.row(0)[2] = 'a';
+    screen.buffer.row(0)[10] = 'b';
+    screen.buffer.row(3)[0] = 'c';
+    screen.buffer.row(3)[9] = 'd';
+    expect(presented(screen) == "\x1b[1;3Ha       b\x1b[4;1Hc\x1b[4;10Hd" && presenter.last().spans_written == 3,
+           "changes under merge_gap apart are merged, changes past it are not");
+    expect(presented(screen).empty() && presenter.last().spans_written == 0, "an unchanged frame writes nothing");
+
+    // Half of the 80 cells is still damage, one more is a full repaint
+    for (size_t x { 0 }; x < 20; ++x) screen.buffer.row(1)[x] = screen.buffer.row(2)[x] = '-';
+    expect(presenter.present(screen).cells_changed == 40 && !presenter.last().full_repaint && presenter.last().spans_written == 2,
+           "changes up to the ratio are written as damage");
+    for (size_t x { 0 }; x < 20; ++x) screen.buffer.row(0)[x] = screen.buffer.row(3)[x] = '+';
+    screen.buffer.row(1)[7] = '*';
+    expect(presented(screen) == full(screen, false) && presenter.last().full_repaint && presenter.last().cells_changed == 41,
+           "changes past the ratio repaint every row, without clearing");
+
+    presenter.invalidate();
+    expect(presented(screen) == full(screen, true), "an invalidated presenter clears and repaints");
+
+    const auto resized = val::make_screen(10, 2);
+    expect(presented(resized) == full(resized, true) && presenter.last().full_repaint, "a resized screen clears and repaints");
+}
+
+void cells()
+{
+    const val::Attributes loud { val::Color::bright_white, val::Color::bright_cyan, true, true, true };
+    const val::Cell32 wide { U'\U0010ffff', loud };
+    expect(wide.glyph() == U'\U0010ffff' && wide.attributes() == loud, "a Cell32 keeps the largest code point and every attribute");
+    expect(wide.with_glyph('q').glyph() == U'q' && wide.with_glyph('q').attributes() == loud, "Cell32::with_glyph keeps the attributes");
+    expect(val::Cell32 { 'x' } == val::Cell32 { U'x' } && val::Cell32 {}.attributes() == val::Attributes {},
+           "a plain Cell32 has the default attributes");
+
+    const val::Cell16 narrow { 'z', loud };
+    expect(narrow.glyph() == U'z' && narrow.attributes() == val::Attributes { val::Color::bright_white, val::Color::bright_cyan },
+           "a Cell16 keeps both colors and drops the styles");
+    expect(narrow.with_glyph('\xe9').glyph() == 0xe9 && narrow.with_glyph('\xe9').attributes() == narrow.attributes(),
+           "Cell16::with_glyph keeps the colors and takes any byte");
+
+    const auto sgr = [](const val::Attributes& attributes) {
+        std::string out {};
+        val::append_sgr(out, attributes);
+        return out;
+    };
+    expect(sgr({}) == "\x1b[0m", "the default attributes are a bare reset");
+    expect(sgr({ val::Color::bright_red, val::Color::blue, true }) == "\x1b[0;1;91;44m", "palette index 9 maps to 91");
+    expect(sgr({ val::Color::black, val::Color::bright_white, false, true, true }) == "\x1b[0;4;7;30;107m",
+           "styles come before the colors, bright backgrounds map onto 100");
+
+    const auto utf8 = [](char32_t glyph) {
+        std::string out {};
+        val::append_utf8(out, glyph);
+        return out;
+    };
+    expect(utf8(U'\x7f') == "\x7f" && utf8(U'\x80') == "\xc2\x80" && utf8(U'\x7ff') == "\xdf\xbf"
+           && utf8(U'\x800') == "\xe0\xa0\x80" && utf8(U'\xffff') == "\xef\xbf\xbf"
+           && utf8(U'\U00010000') == "\xf0\x90\x80\x80" && utf8(U'\U0010ffff') == "\xf4\x8f\xbf\xbf",
+           "code points are encoded in as many UTF-8 bytes as they need");
+
+    // One SGR sequence for as long as the written cells keep their attributes
+    std::ostringstream out {};
+    val::BasicTerminalPresenter<val::Cell32> presenter { out };
+    const auto presented = [&](const val::BasicScreen<val::Cell32>& screen) {
+        out.str({});
+        presenter.present(screen);
+        return out.str();
+    };
+
+    const val::Attributes red { val::Color::bright_red, val::Color::blue, true };
+    const val::Attributes plain {};
+    auto screen = val::make_screen<val::Cell32>(4, 2);
+    for (size_t y { 0 }; y < screen.height; ++y)
+        for (auto& cell : screen.buffer.row(y)) cell = { U'.', red };
+    screen.buffer.row(0)[1] = { U'\xe9', red };
+    screen.buffer.row(1)[3] = { U'\x20ac', red };
+    expect(presented(screen) == "\x1b[2J\x1b[1;1H\x1b[0;1;91;44m.\xc3\xa9..\x1b[2;1H...\xe2\x82\xac"
+           && presenter.last().sgr_written == 1, "a repaint in one style writes one SGR across its rows");
+
+    screen.buffer.row(0)[0] = { U'a', red };
+    screen.buffer.row(1)[3] = { U'b', red };
+    expect(presented(screen) == "\x1b[1;1Ha\x1b[2;4Hb" && presenter.last().sgr_written == 0,
+           "spans in the style the terminal was left in write no SGR");
+
+    screen.buffer.row(1)[0] = { U'c', plain };
+    expect(presented(screen) == "\x1b[2;1H\x1b[0mc" && presenter.last().sgr_written == 1, "a change of style writes one SGR");
+    screen.buffer.row(0)[3] = { U'd', red };
+    expect(presented(screen) == "\x1b[1;4H\x1b[0;1;91;44md" && presenter.last().sgr_written == 1,
+           "a change back writes one SGR again");
+
+    presenter.invalidate();
+    presented(screen);
+    expect(presenter.last().sgr_written == 3, "an invalidated presenter restates the style, then writes it on changes only");
+}
+
+// Just enough of JSON to tell whether a document parses
+class JsonChecker
+{
+public:
+    explicit JsonChecker(std::string_view text) : text_ { text } {}
+
+    bool document() { return value() && (space(), at_ == text_.size()); }
+
+private:
+    void space() { while (at_ < text_.size() && std::string_view { " \t\r\n" }.find(text_[at_]) != std::string_view::npos) ++at_; }
+    bool take(char c) { space(); if (at_ < text_.size() && text_[at_] == c) { ++at_; return true; } return false; }
+    bool peek(char c) { space(); return at_ < text_.size() && text_[at_] == c; }
+
+    bool string()
+    {
+        if (!take('"')) return false;
+        while (at_ < text_.size() && text_[at_] != '"')
+        {
+            if (static_cast<unsigned char>(text_[at_]) < 0x20) return false;
+            at_ += text_[at_] == '\\' ? 2 : 1;
+        }
+        return at_++ < text_.size();
+    }
+
+    bool number()
+    {
+        const size_t start = at_;
+        while (at_ < text_.size() && std::string_view { "+-0123456789.eE" }.find(text_[at_]) != std::string_view::npos) ++at_;
+        return at_ > start;
+    }
+
+    template<class F>
+    bool list(char close, const F& element)
+    {
+        if (take(close)) return true;
+        do { if (!element()) return false; } while (take(','));
+        return take(close);
+    }
+
+    bool value()
+    {
+        if (take('{')) return list('}', [&] { return string() && take(':') && value(); });
+        if (take('[')) return list(']', [&] { return value(); });
+        if (peek('"')) return string();
+        for (const std::string_view word : { "true", "false", "null" })
+            if (text_.substr(at_).starts_with(word)) { at_ += word.size(); return true; }
+        return number();
+    }
+
+    std::string_view    text_;
+    size_t              at_ {0};
+};
+
+// With THEATER_INSTRUMENT on, scopes and counters reach the installed sink
+void instrumentation()
+{
+    const auto record = [] {
+        { THEATER_SCOPE(layout, "check"); }
+        THEATER_COUNT("check_counter", 3);
+        THEATER_COUNT("check_counter", 4);
+    };
+
+    val::instrument::HistogramSink histograms {};
+    val::instrument::set_sink(&histograms);
+    record();
+    val::instrument::set_sink(nullptr);
+    record();
+    const auto scope = histograms.histogram(val::instrument::Phase::layout, "check");
+    expect(histograms.counter("check_counter") == 7 && scope.samples == 1 && scope.min_ns <= scope.max_ns,
+           "the histogram sink sums counters and times scopes, until it is removed");
+
+    val::instrument::ChromeTraceSink trace {};
+    val::instrument::set_sink(&trace);
+    record();
+    val::instrument::set_sink(nullptr);
+
+    std::ostringstream out {};
+    trace.write_json(out);
+    const auto json = std::move(out).str();
+    expect(JsonChecker { json }.document(), "the Chrome trace is well-formed JSON");
+    expect(json.find(R"({"name":"layout","cat":"check","ph":"X")") != std::string::npos
+           && json.find(R"({"name":"check_counter","ph":"C")") != std::string::npos
+           && json.find(R"("args":{"value":7}})") != std::string::npos,
+           "the Chrome trace holds the scope and the running counter");
+    expect(!JsonChecker { R"({"traceEvents":[{"name":"x",}]})" }.document() && !JsonChecker { json.substr(0, json.size() - 3) }.document(),
+           "the JSON check rejects malformed traces");
+}
+
+std::vector<std::string> rows_of(const val::Screen& screen)
+{
+    std::vector<std::string> rows {};
+    for (size_t y { 0 }; y < screen.height; ++y) rows.emplace_back(screen.buffer.row(y).begin(), screen.buffer.row(y).end());
+    return rows;
+}
+
+// The kernels clip at every edge, negative coordinates included, and never write out of bounds
+void raster()
+{
+    namespace raster = val::raster;
+    auto screen = val::make_screen(10, 5);
+    auto& buffer = screen.buffer;
+
+    raster::fill_run(buffer, 0, -5, 3, 'a');
+    raster::fill_run(buffer, 0, 7, 100, 'b');
+    raster::fill_run(buffer, -1, 0, 10, 'x');
+    raster::fill_run(buffer, 5, 0, 10, 'x');
+    raster::fill_run(buffer, 0, 5, 4, 'x');
+    raster::blit_text(buffer, 1, -2, "hello");
+    raster::blit_text(buffer, 1, 8, "xyz");
+    raster::blit_text(buffer, 1, 10, "out");
+    raster::blit_text(buffer, 1, -10, "gone");
+    raster::blit_text(buffer, -3, 0, "gone");
+    raster::framed_run(buffer, 2, -1, 4, '|', '.');
+    raster::framed_run(buffer, 2, 8, 12, '|', ':');
+    raster::frame_box(buffer, 4, 7, 3, 8, raster::BoxStyle { '+', '-', '|', ' ' });
+    raster::frame_box(buffer, -3, 2, -2, 4, raster::BoxStyle { '#', '=', '!', '_' });
+    expect(rows_of(screen) == std::vector<std::string> { "_!a    bbb", "_!o     xy", "_!.|    |:", "=#  +-+   ", "    | |   " },
+           "raster kernels clip at every edge");
+
+    const auto shown = [&](val::Stage frame) { return raster::visible(frame, buffer); };
+    expect(shown({ -5, 1, -3, 0 }) && shown({ 9, 20, 4, 9 }) && shown({ 3, 4, 2, 2 }),
+           "frames with a cell on screen are visible");
+    expect(!shown({ -5, 0, 0, 3 }) && !shown({ 10, 12, 0, 3 }) && !shown({ 0, 3, -4, -1 }) && !shown({ 0, 3, 5, 7 }),
+           "frames beside the screen are not visible");
+    expect(!shown({ 3, 3, 0, 2 }) && !shown({ 5, 2, 0, 2 }) && !shown({ 0, 3, 2, 1 })
+           && !shown({ std::numeric_limits<float>::quiet_NaN(), 3, 0, 2 }), "empty, inverted and NaN frames are not visible");
+}
+
+// Buttons paint clipped, whatever frame they get
+void paint_buttons()
+{
+    const auto painted = [](std::initializer_list<val::Stage> frames, std::string_view script) {
+        auto screen = val::make_screen(10, 4);
+        for (const auto& frame : frames) paint_button(screen, frame, script);
+        return rows_of(screen);
+    };
+    const std::vector<std::string> blank(4, std::string(10, ' '));
+
+    expect(painted({ { 4, 5, 0, 2 } }, "text") == std::vector<std::string> { "    |     ", "    |     ", "    |     ", blank[0] },
+           "a 1-wide button paints its border alone");
+    expect(painted({ { -3, 5, 0, 2 } }, "hello") == std::vector<std::string> { "----|     ", "llo |     ", "----|     ", blank[0] },
+           "a half off-screen button is clipped");
+    expect(painted({ { 20, 30, 0, 2 }, { 2, 8, 6, 8 }, { -10, -2, 0, 2 } }, "hello") == blank,
+           "off-screen buttons paint nothing");
+    expect(painted({ { 1, 9, -1, 1 } }, "hi") == std::vector<std::string> { " |  hi  | ", " |------| ", blank[0], blank[0] },
+           "a button above the screen is clipped at negative coordinates");
+    expect(painted({ { 5, 2, 0, 2 }, { 3, 3, 0, 2 }, { 0, 4, 2, 1 } }, "hi") == blank, "empty and inverted buttons paint nothing");
+
+    // A horizontal stack whose last scene is squeezed into the final column
+    const std::vector<std::string> labels { std::string(20, 'a'), std::string(22, 'b'), "c" };
+    TPerformanceBuffer scenes {};
+    produce_scenes(val::Set { val::Stage { 0, 49, 0, 3 }, {}, val::Crew { dir::stack::horizontally, val::Actor { renderer } } }, scenes, labels);
+    auto screen = val::make_screen(49, 4);
+    for (const auto& scene : scenes) scene.second(screen);
+    expect(scenes.back().first.right - scenes.back().first.left == 1 && screen.buffer.row(1)[48] == '|',
+           "the squeezed last scene of a stack paints its border");
+}
+
+} // namespace tests
+
+int main()
+{
+    tests::packed::check();
+    tests::batch();
+    tests::integer_cells();
+    tests::incremental();
+    tests::layout_cache();
+    tests::arena();
+    tests::containers();
+    tests::scan();
+    tests::flow();
+    tests::interned_scripts();
+    tests::tile_grid();
+    tests::split_actor();
+    tests::stream();
+    tests::async_layout();
+    tests::raster();
+    tests::paint_buttons();
+    tests::presenter();
+    tests::cells();
+    tests::instrumentation();
+    tests::snapshot();
+    tests::shared_screen();
+    tests::async_output();
+
+    if (tests::failures == 0) std::printf("all checks passed\n");
+    return tests::failures == 0 ? 0 : 1;
+}
@@ -8,6 +8,18 @@
 
 #pragma once
 
+#include <algorithm>
+#include <functional>
+#include <memory_resource>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
 // Overloaded lambdas for a pattern match-based resolving of layouting issues
 template<class... Ts> struct overloaded : Ts... { using Ts::operator()...; };
 // explicit deduction guide (not needed as of C++20)
@@ -85,15 +97,28 @@ namespace val
  * [Lenient(0), Strict(20)]     - May start at 0, but not before 0, and must end at 20
  * [Leneint(0), Lenient(20)]    - Anywhere within the range of 0-20
  */
-struct def {
-    const float value;
-    constexpr operator float() const { return value; }
+template<class T>
+struct basic_def {
+    const T value;
+    constexpr operator T() const { return value; }
 }; // strict value
-struct lnt {
-    const float value;
-    constexpr operator float() const { return value; }
+template<class T>
+struct basic_lnt {
+    const T value;
+    constexpr operator T() const { return value; }
 }; // lenient value
 
+/*
+ * Geometry is float by default, which suits pixel based hosts. Every value
+ * type below also comes as a Basic* template over its coordinate type, so a
+ * character grid can run its whole layout in whole cells (int32_t, int16_t)
+ * with no conversions; the stacking kernels, measure_button, paint_button and
+ * layout_batch are generic over it. StageLayout's x_size / y_size are running
+ * sums, so with int16_t they wrap on long sequences; the placed stages do not.
+ */
+using def = basic_def<float>;
+using lnt = basic_lnt<float>;
+
 
 
 /*
@@ -103,17 +128,18 @@ struct lnt {
  * stage and desides whether to stack horizontally or vertically based on that
  * information.
  */
-struct Stage {
+template<class T>
+struct BasicStage {
     enum class Aspect
     {
         horizontal,
         vertical
     };
     
-    const float left;
-    const float right;
-    const float top;
-    const float bottom;
+    const T left;
+    const T right;
+    const T top;
+    const T bottom;
     
     constexpr Aspect aspect() const {
         if (right - left > bottom - top) return Aspect::horizontal;
@@ -121,95 +147,308 @@ struct Stage {
     }
 };
 
-using Direction     = std::variant<def, lnt>;
+using Stage = BasicStage<float>;
+
+template<class T>
+using BasicDirection = std::variant<basic_def<T>, basic_lnt<T>>;
+
+using Direction     = BasicDirection<float>;
 
 // Upper and lower bounds for direction, interpret as either left->right or top->bottom,
 // depending on their usage.
-struct AxisDirection
+template<class T>
+struct BasicAxisDirection
 {
-    const Direction low;
-    const Direction high;
+    const BasicDirection<T> low;
+    const BasicDirection<T> high;
 };
 
+using AxisDirection = BasicAxisDirection<float>;
+
 // TODO: Expand on this
 using performance   = Stage;
 
 // What actors receive from directors
-struct Instruction
+template<class T>
+struct BasicInstruction
+{
+    BasicAxisDirection<T>   horizontal;
+    BasicAxisDirection<T>   vertical;
+};
+
+using Instruction = BasicInstruction<float>;
+
+/*
+ * Contiguous, row-major storage for the cells of a Screen. Rows start
+ * `stride` cells apart (stride >= width), so a row is always a single span
+ * and whole-screen clears and copies are one memory operation.
+ *
+ * buffer[y][x] keeps working: indexing a Framebuffer yields a row span.
+ *
+ * The cells come from a memory resource (the default heap unless given), which
+ * is how a screen can live in shared memory, see shared_screen.hpp.
+ *
+ * Cells are plain chars by default. Packed cells carrying attributes (see
+ * cell.hpp) only need to be constructible from a glyph char, which gives
+ * their blank (`TCell(' ')`), and comparable in a single word.
+ */
+template<class TCell>
+struct BasicFramebuffer
 {
-    AxisDirection     horizontal;
-    AxisDirection     vertical;
+    size_t width  {0};
+    size_t height {0};
+    size_t stride {0};
+    
+    std::pmr::vector<TCell> cells {};
+    
+    std::span<TCell> row(size_t y) { return { cells.data() + y * stride, width }; }
+    std::span<const TCell> row(size_t y) const { return { cells.data() + y * stride, width }; }
+    
+    std::span<TCell> operator[](size_t y) { return row(y); }
+    std::span<const TCell> operator[](size_t y) const { return row(y); }
+    
+    TCell* data() { return cells.data(); }
+    const TCell* data() const { return cells.data(); }
+    
+    void clear(TCell c = TCell(' ')) { std::fill(cells.begin(), cells.end(), c); }
 };
 
+using Framebuffer = BasicFramebuffer<char>;
+
+template<class TCell = char>
+BasicFramebuffer<TCell> make_framebuffer(size_t width, size_t height, size_t stride = 0,
+                                         std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+{
+    stride = std::max(stride, width);
+    return { width, height, stride, std::pmr::vector<TCell>(stride * height, TCell(' '), resource) };
+}
+
 // TODO: Expand on this
-struct Screen
+template<class TCell>
+struct BasicScreen
 {
     const size_t width;
     const size_t height;
     
-    std::vector<std::vector<char>> buffer {};
+    BasicFramebuffer<TCell> buffer {};
 };
 
-Screen make_screen(size_t width, size_t height)
+using Screen = BasicScreen<char>;
+
+template<class TCell = char>
+BasicScreen<TCell> make_screen(size_t width, size_t height, size_t stride = 0,
+                               std::pmr::memory_resource* resource = std::pmr::get_default_resource())
 {
-    Screen screen { width, height };
-    screen.buffer.resize(height);
-    for (auto& row : screen.buffer) {
-        row.resize(width);
-        std::fill(row.begin(), row.end(), ' ');
-    }
-    return screen;
+    return { width, height, make_framebuffer<TCell>(width, height, stride, resource) };
 }
 
 
 using preproduction = std::pair<val::Stage, std::function<void(Screen&)>>;
 
 
-struct StageLayout
+template<class T>
+struct BasicStageLayout
 {
-    float x_offset {0};
-    float y_offset {0};
-    float horizontal_margin {0};
-    float vertical_margin {0};
-    float x_size {0};
-    float y_size {0};
+    T x_offset {0};
+    T y_offset {0};
+    T horizontal_margin {0};
+    T vertical_margin {0};
+    T x_size {0};
+    T y_size {0};
+    
+    bool operator==(const BasicStageLayout&) const = default;
 };
 
+using StageLayout = BasicStageLayout<float>;
 
-using instruct_fn = std::function<Instruction(const Stage&, const StageLayout&)>;
-using adjust_fn = std::function<StageLayout(const Stage&, const performance&, const StageLayout&)>;
 
-struct Director
-{
-    const instruct_fn   instruct;
-    const adjust_fn     adjust;
+/*
+ * Crew members are described by what they can be called with, so a crew whose
+ * members are known at compile time (plain lambdas) composes into a single
+ * inlinable call chain. The std::function based aliases below (Director,
+ * Actor, Crew, Set) remain the opt-in for crews configured at runtime.
+ */
+template<class F>
+concept Instructs = std::is_invocable_r_v<Instruction, const F&, const Stage&, const StageLayout&>;
+
+template<class F>
+concept Adjusts = std::is_invocable_r_v<StageLayout, const F&, const Stage&, const performance&, const StageLayout&>;
+
+template<class F>
+concept Performs = std::is_invocable_r_v<preproduction, const F&, const Instruction&, std::string_view>;
+
+// The two halves of a performance: sizing for an instruction, and painting
+// into the stage the producer settled on
+template<class F, class T = float>
+concept Measures = std::is_invocable_r_v<BasicStage<T>, const F&, const BasicInstruction<T>&, std::string_view>;
+
+/*
+ * Any list of script text with random access, e.g. a std::vector<std::string>
+ * or the std::string_view of every script a val::ScriptTable interned.
+ */
+template<class R>
+concept Scripts = std::ranges::random_access_range<const R> && requires(const R& scripts, size_t idx) {
+    { scripts.size() } -> std::convertible_to<size_t>;
+    { scripts[idx] } -> std::convertible_to<std::string_view>;
 };
 
+template<class F>
+concept Paints = std::is_invocable_v<const F&, Screen&, const Stage&, std::string_view>;
+
 
-using perform_fn = std::function<const preproduction(const Instruction&, const std::string)>;
+template<Instructs Instruct, Adjusts Adjust>
+struct BasicDirector
+{
+    const Instruct      instruct;
+    const Adjust        adjust;
+    const char*         name {"director"}; // for instrumentation and fingerprints
+    
+    // Optional: the director to use for a whole scene sequence on a given
+    // stage, for directors whose rules depend on the stage alone (see bind_director)
+    const BasicDirector* (*bind)(const Stage&) {nullptr};
+};
 
-struct Actor
+/*
+ * Stacks with one of two directors, chosen by the aspect of the stage. Called
+ * directly it chooses on every call; bound to a stage it chooses once.
+ */
+template<class THorizontal, class TVertical>
+struct BasicAspectDirector
 {
-    perform_fn perfom;
+    const THorizontal   horizontal;
+    const TVertical     vertical;
+    const char*         name {"aspect"};
+    
+    template<class T>
+    constexpr BasicInstruction<T> instruct(const BasicStage<T>& stage, const BasicStageLayout<T>& layout) const
+    {
+        return bind(stage, [&](const auto& director) { return director.instruct(stage, layout); });
+    }
+    
+    template<class T>
+    constexpr BasicStageLayout<T> adjust(const BasicStage<T>& stage, const BasicStage<T>& perf, const BasicStageLayout<T>& layout) const
+    {
+        return bind(stage, [&](const auto& director) { return director.adjust(stage, perf, layout); });
+    }
+    
+    template<class T, class F>
+    constexpr decltype(auto) bind(const BasicStage<T>& stage, F&& fn) const
+    {
+        if (stage.aspect() == BasicStage<T>::Aspect::horizontal) return fn(horizontal);
+        return fn(vertical);
+    }
 };
 
+/*
+ * The stage never changes during a scene sequence, so whatever a director
+ * decides from the stage alone can be decided once, before the loop:
+ * bind_director calls fn with the director that stage resolves to, so the
+ * loop inside fn is instantiated for that concrete director and checks no
+ * aspect per scene.
+ *
+ * Directors opt in either with a `bind(stage, fn)` member template (statically
+ * typed directors, which may resolve to a director of another type) or with
+ * the `bind` hook of BasicDirector (runtime-configured directors, which
+ * resolve to another director of the same type). Any other director is
+ * passed through as it is.
+ */
+template<class TDirector, class T, class F>
+constexpr decltype(auto) bind_director(const TDirector& director, const BasicStage<T>& stage, F&& fn)
+{
+    if constexpr (requires { director.bind(stage, fn); })
+    {
+        return director.bind(stage, std::forward<F>(fn));
+    }
+    else if constexpr (requires { { director.bind(stage) } -> std::convertible_to<const TDirector*>; })
+    {
+        const TDirector* bound = director.bind ? director.bind(stage) : nullptr;
+        return fn(bound ? *bound : director);
+    }
+    else
+    {
+        return fn(director);
+    }
+}
 
-struct Crew
+/*
+ * Scripts reach actors as views, and paint closures keep the view rather than
+ * a copy of the text. Whoever owns the scripts (the caller's vector, or a
+ * val::ScriptTable) must keep them alive, unchanged, for as long as the
+ * preproductions made from them are painted.
+ */
+template<Performs Perform>
+struct BasicActor
 {
-    const Director          director;
-    const Actor             actor;
+    Perform perfom;
 };
 
+/*
+ * An actor split into its measure and paint halves. Layout paths that only
+ * need sizes (batches, scans, caches) call measure alone; perfom() combines
+ * both, so a split actor can also be used wherever an Actor is. val::Actor
+ * itself stays a single perform_fn for runtime-configured crews.
+ */
+template<Measures TMeasure, Paints TPaint>
+struct BasicSplitActor
+{
+    const TMeasure  measure;
+    const TPaint    paint;
+    
+    preproduction perfom(const Instruction& instruction, std::string_view script) const
+    {
+        const auto stage = measure(instruction, script);
+        return { stage, [paint = paint, stage, script](Screen& screen) { paint(screen, stage, script); } };
+    }
+};
 
-struct Set
+template<class TDirector, class TActor>
+struct BasicCrew
+{
+    const TDirector         director;
+    const TActor            actor;
+};
+
+template<class TCrew>
+struct BasicSet
 {
     const Stage             stage;
     const StageLayout       stage_layout;
-    const Crew              crew;
+    const TCrew             crew;
+};
+
+/*
+ * A Set while its scenes are being produced. The stage and crew never change
+ * between scenes, so they are borrowed from the Set (which must outlive the
+ * rehearsal); only the running StageLayout is carried forward, in place.
+ */
+template<class TCrew>
+struct BasicRehearsal
+{
+    const Stage&            stage;
+    const TCrew&            crew;
+    StageLayout             stage_layout;
+    
+    explicit BasicRehearsal(const BasicSet<TCrew>& set)
+    : stage { set.stage }, crew { set.crew }, stage_layout { set.stage_layout }
+    {}
 };
 
-constexpr auto extract = [](const Direction& value) -> const float {
-    const auto extractor = [](const auto& v) -> const float {
+
+using instruct_fn = std::function<Instruction(const Stage&, const StageLayout&)>;
+using adjust_fn = std::function<StageLayout(const Stage&, const performance&, const StageLayout&)>;
+using perform_fn = std::function<const preproduction(const Instruction&, std::string_view)>;
+using measure_fn = std::function<Stage(const Instruction&, std::string_view)>;
+using paint_fn = std::function<void(Screen&, const Stage&, std::string_view)>;
+
+using Director  = BasicDirector<instruct_fn, adjust_fn>;
+using Actor     = BasicActor<perform_fn>;
+using SplitActor = BasicSplitActor<measure_fn, paint_fn>;
+using Crew      = BasicCrew<Director, Actor>;
+using Set       = BasicSet<Crew>;
+using Rehearsal = BasicRehearsal<Crew>;
+
+constexpr auto extract = []<class T>(const BasicDirection<T>& value) -> const T {
+    const auto extractor = [](const auto& v) -> const T {
         return v.value;
     };
     
@@ -218,29 +457,31 @@ constexpr auto extract = [](const Direction& value) -> const float {
 
 // Resolves either an axis instruction with an incoming value, or
 // (at the bottom) individual directional values with an incoming value.
-constexpr auto resolve_axis = [](const AxisDirection& instruction, const float incoming_value) -> const float {
+constexpr auto resolve_axis = []<class T>(const BasicAxisDirection<T>& instruction, const std::type_identity_t<T> incoming_value) -> const T {
+    using def = basic_def<T>;
+    using lnt = basic_lnt<T>;
     const auto resolver = overloaded {
         [&]
-        (const def& lower, const def& upper) -> const float {
+        (const def& lower, const def& upper) -> const T {
             if (incoming_value < lower.value) return lower.value;
             return upper.value;
         },
         
         [&]
-        (const def& lower, const lnt& upper) -> const float {
+        (const def& lower, const lnt& upper) -> const T {
             if (incoming_value < lower.value) return lower.value;
             
             return std::min(upper.value, incoming_value);
         },
         
         [&]
-        (const lnt& lower, const lnt& upper) -> const float {
+        (const lnt& lower, const lnt& upper) -> const T {
             if (incoming_value < lower.value) return lower.value;
             return std::min(upper.value, incoming_value);
         },
         
         [&]
-        (const lnt& lower, const def& upper) -> const float {
+        (const lnt& lower, const def& upper) -> const T {
             return upper.value;
         },
     };
@@ -248,14 +489,14 @@ constexpr auto resolve_axis = [](const AxisDirection& instruction, const float i
     return std::visit(resolver, instruction.low, instruction.high);
 };
 
-constexpr auto resolve_direction = [](const Direction& dir, const float incoming_value) -> const float {
+constexpr auto resolve_direction = []<class T>(const BasicDirection<T>& dir, const std::type_identity_t<T> incoming_value) -> const T {
     return std::visit(overloaded {
         [&incoming_value]
-        (const lnt& direction) -> const float {
+        (const basic_lnt<T>& direction) -> const T {
             return std::min(direction.value, incoming_value);
         },
         []
-        (const def& direction) -> const float {
+        (const basic_def<T>& direction) -> const T {
             return direction.value;
         }
     }, dir);
@@ -0,0 +1,163 @@
+//
+//  window.hpp
+//  playground
+//
+//  Windowed layout of long vertically stacked lists.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "typedefs.hpp"
+#include "directors.hpp"
+#include "batch.hpp"
+
+namespace val
+{
+
+/*
+ * Where each row of a vertical stack starts, without laying the rows out.
+ * Either every row has the same extent (fixed), or the extents were measured
+ * once and are cached as prefix offsets. Either way the first row visible at a
+ * given y is found directly (O(1) fixed, O(log n) cached).
+ *
+ * Cached offsets are accumulated in the same order as vertical_adjust, so they
+ * match a full layout exactly; fixed offsets are start + idx * step, exact for
+ * whole-cell geometry.
+ */
+class RowIndex
+{
+public:
+    // Rows of equal extent (bottom - top of a placed row)
+    static RowIndex fixed(size_t count, float extent, const StageLayout& layout)
+    {
+        RowIndex index { layout };
+        index.count_ = count;
+        index.step_ = (extent + 1) + layout.vertical_margin;
+        return index;
+    }
+
+    // Rows of known extents
+    static RowIndex cached(std::span<const float> extents, const StageLayout& layout)
+    {
+        RowIndex index { layout };
+        index.count_ = extents.size();
+        index.offsets_.reserve(extents.size() + 1);
+        float offset = layout.y_offset;
+        for (const auto extent : extents)
+        {
+            index.offsets_.push_back(offset);
+            offset += (extent + 1) + layout.vertical_margin;
+        }
+        index.offsets_.push_back(offset);
+        return index;
+    }
+
+    // Measures every row once against the stage, for a cached index
+    template<Measures TMeasure, Scripts TScripts>
+    static RowIndex measured(const Stage& stage, const StageLayout& layout, const TMeasure& measure,
+                             const TScripts& scripts)
+    {
+        std::vector<float> extents {};
+        extents.reserve(scripts.size());
+        const auto instruction = dir::stack::kernel::vertical_next(stage, layout);
+        for (const auto& script : scripts)
+        {
+            const auto placed = measure(instruction, script);
+            extents.push_back(placed.bottom - placed.top);
+        }
+        return cached(extents, layout);
+    }
+
+    size_t size() const { return count_; }
+
+    // The y_offset row `idx` is placed at (idx == size() gives the end of the list)
+    float offset(size_t idx) const
+    {
+        if (offsets_.empty()) return layout_.y_offset + static_cast<float>(idx) * step_;
+        return offsets_[idx];
+    }
+
+    // The first row that ends at or below `y`
+    size_t first_reaching(float y) const
+    {
+        if (offsets_.empty())
+        {
+            if (step_ <= 0 || y <= layout_.y_offset) return 0;
+            const auto idx = static_cast<size_t>((y - layout_.y_offset) / step_);
+            return std::min(idx, count_);
+        }
+        // offsets_[idx + 1] is where the row after idx starts
+        const auto found = std::upper_bound(offsets_.begin() + 1, offsets_.end(), y);
+        return std::min(static_cast<size_t>(found - offsets_.begin()) - 1, count_);
+    }
+
+    // One past the last row that starts before `y`
+    size_t end_before(float y) const
+    {
+        if (offsets_.empty())
+        {
+            if (step_ <= 0) return count_;
+            if (y <= layout_.y_offset) return 0;
+            const auto idx = static_cast<size_t>(std::ceil((y - layout_.y_offset) / step_));
+            return std::min(idx, count_);
+        }
+        const auto found = std::lower_bound(offsets_.begin(), offsets_.end() - 1, y);
+        return static_cast<size_t>(found - offsets_.begin());
+    }
+
+    const StageLayout& layout() const { return layout_; }
+
+private:
+    explicit RowIndex(const StageLayout& layout) : layout_ { layout } {}
+
+    StageLayout         layout_;
+    size_t              count_ {0};
+    float               step_ {0};
+    std::vector<float>  offsets_ {};
+};
+
+// The rows [top, bottom) of the stacking axis that are on screen
+struct Viewport
+{
+    float top;
+    float bottom;
+};
+
+/*
+ * Lays out only the rows of a dir::stack::vertically list that intersect the
+ * viewport, plus `overscan` rows on either side, jumping straight to the first
+ * of them through the index. Cost is proportional to the rows on screen, not
+ * to the length of the list.
+ *
+ * Placed stages are appended to `into` with their index in `scripts`, and are
+ * identical to the same rows of a full layout as long as the index matches
+ * the scripts.
+ */
+template<Measures TMeasure, Scripts TScripts>
+void layout_window(const Stage& stage, const RowIndex& index, const TMeasure& measure,
+                   const TScripts& scripts, const Viewport& viewport, size_t overscan, SceneBatch& into)
+{
+    const size_t count = std::min(index.size(), scripts.size());
+    const size_t first = std::min(index.first_reaching(viewport.top), count);
+    const size_t last  = std::min(index.end_before(viewport.bottom), count);
+    const size_t begin = first - std::min(first, overscan);
+    const size_t end   = std::min(count, std::max(last, first) + overscan);
+
+    auto layout = index.layout();
+    layout.y_offset = index.offset(begin);
+    into.reserve(into.size() + (end - begin));
+    for (size_t idx { begin }; idx < end; ++idx)
+    {
+        const auto placed = measure(dir::stack::kernel::vertical_next(stage, layout), scripts[idx]);
+        layout = dir::stack::kernel::vertical_adjust(stage, placed, layout);
+        into.push_back(placed, idx);
+    }
+}
+
+} // namespace val